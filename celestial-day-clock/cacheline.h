@@ -0,0 +1,17 @@
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+#include <atomic>
+#include <cstddef>
+
+inline constexpr size_t cacheLineSize = 64;
+
+/* An atomic padded out to its own cache line, so that threads writing neighbouring flags and
+   counters do not contend for the same line */
+template <typename T>
+struct alignas(cacheLineSize) PaddedAtomic : std::atomic<T> {
+	using std::atomic<T>::atomic;
+	using std::atomic<T>::operator=;
+};
+
+#endif
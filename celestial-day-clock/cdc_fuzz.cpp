@@ -0,0 +1,36 @@
+// A libFuzzer target for the clock harness. Build it with every source file except main.cpp:
+// clang++ -std=c++20 -g -O1 -fsanitize=fuzzer,address,undefined $(ls *.cpp | grep -v main.cpp)
+// Defining CDC_FUZZ_STANDALONE instead builds a driver that replays the input files it is given.
+#include "clockharness.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, size_t size) {
+	static const ClockHarness harness;
+	std::string failure;
+
+	if (!harness.check(ClockCase::fromBytes(data, size), failure)) {
+		std::cerr << failure << std::endl;
+		std::abort();
+	}
+
+	return 0;
+}
+
+#ifdef CDC_FUZZ_STANDALONE
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char** argv) {
+	for (int argIndex = 1; argIndex < argc; ++argIndex) {
+		std::ifstream in(argv[argIndex], std::ios::binary);
+		const std::vector<std::uint8_t> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	return 0;
+}
+#endif
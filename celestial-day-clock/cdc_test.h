@@ -1,6 +1,8 @@
 #ifndef CDC_TEST_H
 #define CDC_TEST_H
 
+#include <cstdint>
+#include <ctime>
 #include <string>
 
 namespace cdc_test {
@@ -31,6 +33,90 @@ namespace cdc_test {
 	constexpr int decimalRadixMax = decimalRadix - 1;
 	constexpr int hours = 4;
 	constexpr int minutes = 58;
+	constexpr int renderOrreryCount = 64;
+	constexpr int renderClockCount = 80;
+	constexpr int widenedBodyHours = 100000;
+	constexpr int schedulerIntervalMilliseconds = 5;
+	constexpr int scheduledTicks = 3;
+	constexpr int threadedTicks = 2;
+	constexpr int simulatedDays = 3;
+	constexpr std::uint64_t replayRewindSeconds = 5000;
+	constexpr int indexOrreryCount = 3;
+	constexpr int indexClockCount = 40;
+	constexpr int indexTicks = 5000;
+	constexpr int rolloverWindowSeconds = 600;
+	constexpr int windowStartHours = 6;
+	constexpr int phaseSamples = 100000;
+	constexpr size_t terminalRows = 3;
+	constexpr size_t terminalColumns = 12;
+	constexpr size_t serverSubscribers = 256;
+	constexpr int serverTicks = 3;
+	constexpr int serverAttempts = 1000;
+	constexpr int serverPollMilliseconds = 10;
+	constexpr size_t serverPipelinedRequests = 2000;
+	constexpr int viewOffsets[] = { 1, 3600, -5 * 3600, 12 * 3600 + 30 };
+	constexpr int viewTicks = 90000;
+	constexpr int viewCheckInterval = 997;
+	constexpr int viewRenderTicks = 125;
+	constexpr int viewRenderAttempts = 5;
+	constexpr int slabTestClocks = 150;
+	constexpr int benchOrreryCount = 64;
+	constexpr int benchClockCount = 2048;
+	constexpr int benchTicks = 200;
+	constexpr size_t harnessEngines = 3;
+	constexpr size_t harnessCases = 400;
+	constexpr int harnessBodyHours[] = { 0, 1, 23, 24, 25, 687 };
+	constexpr int harnessBodyMinutes[] = { 0, 27, 55, 56, 57, 59 };
+	constexpr std::uint32_t harnessEdgeTicks = 2;
+	constexpr int traceClockCount = 4;
+	constexpr char traceFileName[] = "cdc_trace.json";
+	constexpr int memoryClocks = 6;
+	constexpr size_t memoryAllocationBytes = 256;
+	constexpr int memoryReportClockCounts[] = { 16, 256, 2048 };
+	constexpr int planOrreryClockCounts[] = { 3, 0, 40, 7, 90, 1 };
+	constexpr int planTicks = 4000;
+	constexpr int staticOrreryCount = 5;
+	constexpr int staticTicks = 90000;
+	constexpr std::time_t epochTime = 1700000000;
+	constexpr int epochDays = 1000;
+	constexpr int epochSteps = 200;
+	constexpr int epochStartSeconds = 3600;
+	constexpr int epochToleranceSeconds = 2;
+	constexpr int historyClockCount = 6;
+	constexpr size_t historyCapacity = 300;
+	constexpr int historyTicks = 1000;
+	constexpr int historySetInterval = 97;
+	constexpr int columnarLogClockCount = 8;
+	constexpr int columnarLogTicks = 1000;
+	constexpr std::uint64_t columnarLogInterval = 5;
+	constexpr size_t columnarLogBlockSamples = 64;
+	constexpr size_t columnarLogMinRatio = 20;
+	constexpr size_t columnarLogWideClocks = 100000;
+	constexpr size_t shardCount = 3;
+	constexpr int shardOrreryCount = 6;
+	constexpr int shardClockCount = 5;
+	constexpr int shardTicks = 50;
+	constexpr size_t shardBenchCounts[] = { 1, 2, 4 };
+	constexpr int loaderOrreryCount = 40;
+	constexpr int loaderClockCount = 1500;
+	constexpr size_t loaderThreadCount = 4;
+	constexpr char loaderFileName[] = "cdc_clocks.csv";
+	constexpr int renderCacheOrreryCount = 4;
+	constexpr int renderCacheClockCount = 200;
+	constexpr int renderCacheTicks = 30;
+	constexpr int renderBenchClockCount = 256;
+	constexpr int rankingOrreryCount = 4;
+	constexpr int rankingClockCount = 50;
+	constexpr int rankingTicks = 200;
+	constexpr size_t rankingParallelClocks = 200000;
+	constexpr size_t rankingThreadCount = 4;
+	constexpr int reprofileOrreryCount = 6;
+	constexpr int reprofileClockCount = 60;
+	constexpr int reprofileRounds = 50;
+	constexpr int reprofileBodyHours = 10;
+	constexpr int reprofileBodyMinutes = 39;
+	constexpr int reprofileEpochSeconds = 6 * 3600;
+	constexpr int reprofileToleranceSeconds = 4;
 	constexpr int expectedMinutes = senaryRadixMax * decimalRadix + senaryRadix;
 	const ClockUnitValues time1 = { hours / 2 - 1,
 	 senaryRadixMax, decimalRadixMax,
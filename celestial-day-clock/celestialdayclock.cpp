@@ -1,62 +1,140 @@
 #include "celestialdayclock.h"
+#include "dayphase.h"
+#include "tickplan.h"
+#include "tracer.h"
+#include <atomic>
+#include <charconv>
 
-CelestialDayClock::CelestialDayClock(int h, int m) { setBodyMaximums(h, m); }
+static std::atomic<std::uint64_t> stateEpoch = 0;
 
-void CelestialDayClock::setHours(int h) { hours = clamp(h, maxHours); }
+static void advanceStateEpoch() { stateEpoch.fetch_add(1, std::memory_order_relaxed); }
 
-void CelestialDayClock::setMinutesDigit1(int m) { minutesDigit1 = clamp(m, radixMax); }
+// A new clock belongs to no timepiece yet, so taking its first profile needs no new revision
+CelestialDayClock::CelestialDayClock(int h, int m) : profileId(DayProfile::fromBodyMaximums(h, m)) {}
 
-void CelestialDayClock::setMinutesDigit2(int m) { minutesDigit2 = clamp(m, secondaryRadixMax); }
+void CelestialDayClock::setHours(int h) {
+	hours = clamp(h, getProfile().maxHours);
+	advanceStateEpoch();
+}
+
+void CelestialDayClock::setMinutesDigit1(int m) {
+	minutesDigit1 = clamp(m, radixMax);
+	advanceStateEpoch();
+}
 
-void CelestialDayClock::setSecondsDigit1(int s) { secondsDigit1 = clamp(s, radixMax); }
+void CelestialDayClock::setMinutesDigit2(int m) {
+	minutesDigit2 = clamp(m, secondaryRadixMax);
+	advanceStateEpoch();
+}
 
-void CelestialDayClock::setSecondsDigit2(int s) { secondsDigit2 = clamp(s, secondaryRadixMax); }
+void CelestialDayClock::setSecondsDigit1(int s) {
+	secondsDigit1 = clamp(s, radixMax);
+	advanceStateEpoch();
+}
 
-void CelestialDayClock::setBodyMaximums(int h, int m) {
-	constexpr int halfMaxBodyMinutes = (radixMax / 2 * secondaryRadix + secondaryRadixMax) - 1;
+void CelestialDayClock::setSecondsDigit2(int s) {
+	secondsDigit2 = clamp(s, secondaryRadixMax);
+	advanceStateEpoch();
+}
 
-	if (h < maxHoursMin) h = maxHoursMin;
+void CelestialDayClock::setBodyMaximums(int h, int m) {
+	const DayProfile::Id id = DayProfile::fromBodyMaximums(h, m);
 
-	maxHours = h;
+	if (id != profileId) lastProfileRevision() = nextRevision();
 
-	m = m / 2;
+	profileId = id;
+	hours = clamp(hours, getProfile().maxHours);
+	advanceStateEpoch();
+}
 
-	if (m < 0) m = 0;
+std::vector<int> CelestialDayClock::getBodyMaximums() const {
+	const DayProfile& profile = getProfile();
 
-	if (m % 2 == 1) --m;
+	return { profile.bodyMaxHours, profile.bodyMaxMinutes };
+}
 
-	if (m > halfMaxBodyMinutes) m = halfMaxBodyMinutes;
+void CelestialDayClock::setSecondsOfDay(int seconds) {
+	syncSecondsOfDay(seconds);
+	advanceStateEpoch();
+}
 
-	maxMinutes = m;
+void CelestialDayClock::syncSecondsOfDay(int seconds) {
+	const DayProfile& profile = getProfile();
+	int remainder = (seconds % profile.daySeconds + profile.daySeconds) % profile.daySeconds;
 
-	if (maxHours % 2 == 1) {
-		--maxHours;
-		maxMinutes += radix * secondaryRadix / 2;
+	if (profile.maxMinutes == 0 || remainder < profile.halfDaySeconds) {
+		hours = remainder / DayProfile::secondsPerHour;
+	}
+	else {
+		remainder -= profile.halfDaySeconds;
+		hours = profile.halfHours + 1 + remainder / DayProfile::secondsPerHour;
 	}
 
-	if (maxMinutes > 0) ++maxHours;
+	remainder %= DayProfile::secondsPerHour;
+	minutesDigit1 = static_cast<std::uint8_t>(remainder / DayProfile::secondsPerMinute / secondaryRadix);
+	minutesDigit2 = static_cast<std::uint8_t>(remainder / DayProfile::secondsPerMinute % secondaryRadix);
+	secondsDigit1 = static_cast<std::uint8_t>(remainder % DayProfile::secondsPerMinute / secondaryRadix);
+	secondsDigit2 = static_cast<std::uint8_t>(remainder % secondaryRadix);
 }
-std::vector<int> CelestialDayClock::getBodyMaximums() const {
-	const bool hasTrulyOddMaxHours = maxHours % 2 == 1 && maxMinutes >= radix * secondaryRadix / 2;
-	int bodyMaxHours = 0;
-	int bodyMaxMinutes = 0;
 
-	if (hasTrulyOddMaxHours || maxMinutes == 0) bodyMaxHours = maxHours;
-	else bodyMaxHours = maxHours - 1;
+int CelestialDayClock::getSecondsOfDay() const {
+	const DayProfile& profile = getProfile();
+	const int secondsOfDay = profile.toSecondsOfDay(hours,
+		minutesDigit1 * secondaryRadix + minutesDigit2, secondsDigit1 * secondaryRadix + secondsDigit2);
+
+	return secondsOfDay % profile.daySeconds;
+}
+
+// Seconds of day already account for the half-day and end-of-day resets, so rewinding is one step
+void CelestialDayClock::rewind(std::uint64_t seconds) {
+	const int daySeconds = getProfile().daySeconds;
+
+	setSecondsOfDay(getSecondsOfDay() - static_cast<int>(seconds % static_cast<std::uint64_t>(daySeconds)));
+}
+
+void CelestialDayClock::setProfile(DayProfile::Id id, int secondsOfDay) {
+	syncProfile(id, secondsOfDay);
+	advanceStateEpoch();
+}
+
+void CelestialDayClock::syncProfile(DayProfile::Id id, int secondsOfDay) {
+	// Throws before any field changes if the profile was never interned
+	DayProfile::get(id);
+
+	if (id != profileId) lastProfileRevision() = nextRevision();
 
-	if (bodyMaxHours % 2 == 1) bodyMaxMinutes = (maxMinutes - radix * secondaryRadix / 2) * 2;
-	else bodyMaxMinutes = maxMinutes * 2;
+	profileId = id;
+	syncSecondsOfDay(secondsOfDay);
+}
+
+void CelestialDayClock::setDayPhase(std::uint32_t phase) {
+	setSecondsOfDay(DayPhase::toSecondsOfDay(phase, getProfile()));
+}
 
-	return { bodyMaxHours, bodyMaxMinutes };
+std::uint32_t CelestialDayClock::getDayPhase() const {
+	return DayPhase::fromSecondsOfDay(getSecondsOfDay(), getProfile());
 }
 
 std::string CelestialDayClock::getTimeMilitary() const {
+	CDC_TRACE_SCOPE("CelestialDayClock::getTimeMilitary");
+
 	return std::to_string(hours) + delimiter +
 		std::to_string(minutesDigit1) + std::to_string(minutesDigit2) + delimiter +
 		std::to_string(secondsDigit1) + std::to_string(secondsDigit2);
 }
 
+size_t CelestialDayClock::formatTimeMilitary(char* out) const {
+	CDC_TRACE_SCOPE("CelestialDayClock::formatTimeMilitary");
+	char* const end = formatDigits(std::to_chars(out, out + maxTimeLength, hours).ptr);
+
+	return end - out;
+}
+
 int CelestialDayClock::getStandardHours() const {
+	const DayProfile& profile = getProfile();
+	const int maxHours = profile.maxHours;
+	const int maxMinutes = profile.maxMinutes;
+
 	if (maxMinutes == 0 && hours == 0) return maxHours / 2;
 
 	if (maxMinutes == 0 && hours == maxHours) return 0;
@@ -68,22 +146,41 @@ int CelestialDayClock::getStandardHours() const {
 	return hours;
 }
 
-std::string CelestialDayClock::getMeridiemIndicator() const {
-	if (maxMinutes == 0 && hours >= maxHours / 2 && hours != maxHours)
-		return { ' ', postChar, meridiemChar };
+bool CelestialDayClock::isPostMeridiem() const {
+	const DayProfile& profile = getProfile();
+	const int maxHours = profile.maxHours;
+	const int maxMinutes = profile.maxMinutes;
 
-	if (maxMinutes != 0 && hours > maxHours / 2) return { ' ', postChar, meridiemChar };
+	if (maxMinutes == 0 && hours >= maxHours / 2 && hours != maxHours) return true;
 
-	return { ' ', anteChar, meridiemChar };
+	return maxMinutes != 0 && hours > maxHours / 2;
+}
+
+std::string CelestialDayClock::getMeridiemIndicator() const {
+	return { ' ', isPostMeridiem() ? postChar : anteChar, meridiemChar };
 }
 
 std::string CelestialDayClock::getTime() const {
+	CDC_TRACE_SCOPE("CelestialDayClock::getTime");
+
 	return std::to_string(getStandardHours()) + delimiter +
 		std::to_string(minutesDigit1) + std::to_string(minutesDigit2) + delimiter +
 		std::to_string(secondsDigit1) + std::to_string(secondsDigit2) + getMeridiemIndicator();
 }
 
+size_t CelestialDayClock::formatTime(char* out) const {
+	CDC_TRACE_SCOPE("CelestialDayClock::formatTime");
+	char* end = formatDigits(std::to_chars(out, out + maxTimeLength, getStandardHours()).ptr);
+
+	*end++ = ' ';
+	*end++ = isPostMeridiem() ? postChar : anteChar;
+	*end++ = meridiemChar;
+
+	return end - out;
+}
+
 std::vector<std::string> CelestialDayClock::getTimes() {
+	CDC_TRACE_SCOPE("CelestialDayClock::getTimes");
 	std::vector<std::string> times;
 
 	times.push_back(getTimeMilitary());
@@ -92,49 +189,21 @@ std::vector<std::string> CelestialDayClock::getTimes() {
 	return times;
 }
 
-bool CelestialDayClock::checkTimeReset() {
-	const bool areHoursMax = hours >= maxHours - 1 &&
-		minutesDigit1 == radixMax && minutesDigit2 == secondaryRadixMax;
-	const bool areMinutesMax = (hours == maxHours / 2 || hours >= maxHours) &&
-		minutesDigit1 * secondaryRadix + minutesDigit2 >= maxMinutes - 1;
-	const bool areSecondsMax = secondsDigit1 == radixMax && secondsDigit2 == secondaryRadixMax;
-	bool isReset = false;
-
-	if (maxMinutes == 0 && areHoursMax && areSecondsMax) {
-		hours = 0;
-		minutesDigit1 = 0;
-		minutesDigit2 = 0;
-		secondsDigit1 = 0;
-		secondsDigit2 = 0;
-		isReset = true;
-	}
+MemoryUsage CelestialDayClock::memoryUsage() const {
+	MemoryUsage usage;
 
-	if (maxMinutes != 0 && areMinutesMax && areSecondsMax) {
-		hours = hours == maxHours / 2 ? maxHours / 2 + 1 : 0;
-		minutesDigit1 = 0;
-		minutesDigit2 = 0;
-		secondsDigit1 = 0;
-		secondsDigit2 = 0;
-		isReset = true;
-	}
+	usage.stateBytes = sizeof(CelestialDayClock);
 
-	return isReset;
+	return usage;
 }
 
-void CelestialDayClock::tick() {
-	if (checkTimeReset()) return;
-
-	++secondsDigit2;
+std::uint64_t CelestialDayClock::getStateEpoch() { return stateEpoch.load(std::memory_order_relaxed); }
 
-	if (secondsDigit2 >= secondaryRadix) {
-		secondsDigit2 = 0;
-		++secondsDigit1;
+void CelestialDayClock::compileTickPlan(TickPlan& plan) {
+	CelestialDayClock* const clock = this;
 
-		if (secondsDigit1 >= radix) {
-			secondsDigit1 = 0;
-			tickMinutes();
-		}
-	}
+	plan.addClocks(&clock, 1);
+	plan.addBoundary();
 }
 
 int CelestialDayClock::clamp(const int value, const int max) const {
@@ -145,16 +214,13 @@ int CelestialDayClock::clamp(const int value, const int max) const {
 	return value;
 }
 
-void CelestialDayClock::tickMinutes() {
-	++minutesDigit2;
+char* CelestialDayClock::formatDigits(char* out) const {
+	*out++ = delimiter;
+	*out++ = static_cast<char>('0' + minutesDigit1);
+	*out++ = static_cast<char>('0' + minutesDigit2);
+	*out++ = delimiter;
+	*out++ = static_cast<char>('0' + secondsDigit1);
+	*out++ = static_cast<char>('0' + secondsDigit2);
 
-	if (minutesDigit2 >= secondaryRadix) {
-		minutesDigit2 = 0;
-		++minutesDigit1;
-
-		if (minutesDigit1 >= radix) {
-			minutesDigit1 = 0;
-			++hours;
-		}
-	}
+	return out;
 }
\ No newline at end of file
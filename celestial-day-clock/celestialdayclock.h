@@ -2,7 +2,10 @@
 #define CELESTIAL_DAY_CLOCK_H
 
 #include "celestialtimepiece.h"
+#include "dayprofile.h"
 #include "numeric_limits.h"
+#include "tracer.h"
+#include <cstdint>
 #include <ctime>
 #include <string>
 #include <vector>
@@ -20,6 +23,7 @@ public:
 	static constexpr int radixMax = radix - 1;
 	static constexpr int secondaryRadix = numeric_limits<std::time_t>::radices[1];
 	static constexpr int secondaryRadixMax = secondaryRadix - 1;
+	static constexpr size_t maxTimeLength = 20;
 
 	CelestialDayClock(int h, int m);
 
@@ -41,32 +45,141 @@ public:
 	void setBodyMaximums(int h, int m);
 	std::vector<int> getBodyMaximums() const;
 
+	void setSecondsOfDay(int seconds);
+	int getSecondsOfDay() const;
+
+	void rewind(std::uint64_t seconds);
+
+	void setDayPhase(std::uint32_t phase);
+	std::uint32_t getDayPhase() const;
+
+	DayProfile::Id getProfileId() const { return profileId; }
+
+	// Moves the clock to another day profile at a time of day on that profile, so every field fits the new day
+	void setProfile(DayProfile::Id id, int secondsOfDay);
+
+	const DayProfile& getProfile() const { return DayProfile::get(profileId); }
+
 	std::string getTimeMilitary() const;
 
+	size_t formatTimeMilitary(char* out) const;
+
 	int getStandardHours() const;
 
+	bool isPostMeridiem() const;
+
 	std::string getMeridiemIndicator() const;
 
 	std::string getTime() const;
 
+	size_t formatTime(char* out) const;
+
 	std::vector<std::string> getTimes() override;
 
+	MemoryUsage memoryUsage() const override;
+
+	void compileTickPlan(TickPlan& plan) override;
+
 	bool checkTimeReset();
 
+	/* Tick plans and static timepieces call this without virtual dispatch, so subclasses must not
+	   change how a clock ticks. DerivedDayClock may override it, as its clocks never enter a plan */
 	void tick() override;
 
+	// Changes whenever any clock's time or day length is set directly, rather than ticked or synced
+	static std::uint64_t getStateEpoch();
+
+protected:
+	// Sets the time without a new state epoch, for clocks whose time follows another clock or the wall time
+	void syncSecondsOfDay(int seconds);
+
+	// Moves the clock to another day profile like setProfile, also without a new state epoch
+	void syncProfile(DayProfile::Id id, int secondsOfDay);
+
 private:
-	int maxHours = 0;
-	int maxMinutes = 0;
 	int hours = 0;
-	int minutesDigit1 = 0;
-	int minutesDigit2 = 0;
-	int secondsDigit1 = 0;
-	int secondsDigit2 = 0;
+	DayProfile::Id profileId = 0;
+	std::uint8_t minutesDigit1 = 0;
+	std::uint8_t minutesDigit2 = 0;
+	std::uint8_t secondsDigit1 = 0;
+	std::uint8_t secondsDigit2 = 0;
 
 	int clamp(const int value, const int max) const;
 
+	char* formatDigits(char* out) const;
+
 	void tickMinutes();
 };
 
+// Ticking is defined here so that loops over clocks held by value can inline it
+inline bool CelestialDayClock::checkTimeReset() {
+	CDC_TRACE_SCOPE("CelestialDayClock::checkTimeReset");
+
+	// Resets only happen on the last second of a minute, so other ticks skip the profile lookup
+	if (secondsDigit1 != radixMax || secondsDigit2 != secondaryRadixMax) return false;
+
+	const DayProfile& profile = getProfile();
+	const int maxHours = profile.maxHours;
+	const int maxMinutes = profile.maxMinutes;
+	const bool areHoursMax = hours >= profile.hoursResetThreshold &&
+		minutesDigit1 == radixMax && minutesDigit2 == secondaryRadixMax;
+	const bool areMinutesMax = (hours == profile.halfHours || hours >= maxHours) &&
+		minutesDigit1 * secondaryRadix + minutesDigit2 >= profile.minutesResetThreshold;
+	bool isReset = false;
+
+	if (maxMinutes == 0 && areHoursMax) {
+		hours = 0;
+		minutesDigit1 = 0;
+		minutesDigit2 = 0;
+		secondsDigit1 = 0;
+		secondsDigit2 = 0;
+		isReset = true;
+	}
+
+	if (maxMinutes != 0 && areMinutesMax) {
+		hours = hours == profile.halfHours ? profile.halfHours + 1 : 0;
+		minutesDigit1 = 0;
+		minutesDigit2 = 0;
+		secondsDigit1 = 0;
+		secondsDigit2 = 0;
+		isReset = true;
+	}
+
+	return isReset;
+}
+
+inline void CelestialDayClock::tick() {
+	CDC_TRACE_SCOPE("CelestialDayClock::tick");
+
+	if (checkTimeReset()) return;
+
+	++secondsDigit2;
+
+	if (secondsDigit2 >= secondaryRadix) {
+		secondsDigit2 = 0;
+		++secondsDigit1;
+
+		if (secondsDigit1 >= radix) {
+			secondsDigit1 = 0;
+			tickMinutes();
+		}
+	}
+}
+
+inline void CelestialDayClock::tickMinutes() {
+	CDC_TRACE_SCOPE("CelestialDayClock::tickMinutes");
+
+	++minutesDigit2;
+
+	if (minutesDigit2 >= secondaryRadix) {
+		minutesDigit2 = 0;
+		++minutesDigit1;
+
+		if (minutesDigit1 >= radix) {
+			minutesDigit1 = 0;
+			++hours;
+		}
+	}
+}
+
 #endif
\ No newline at end of file
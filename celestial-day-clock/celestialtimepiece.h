@@ -1,9 +1,15 @@
 #ifndef CELESTIAL_TIMEPIECE_H
 #define CELESTIAL_TIMEPIECE_H
 
+#include "memoryusage.h"
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
 #include <string>
 
+class TickPlan;
+
 // ADT for a celestial timepiece that provides the current times and ticks to the next times
 class CelestialTimepiece {
 public:
@@ -11,7 +17,42 @@ public:
 
 	virtual std::vector<std::string> getTimes() = 0;
 
+	/* The bytes this timepiece holds, apart from the allocation that holds the timepiece itself. Only
+	   the base object is known here, so timepieces that hold more than that override this */
+	virtual MemoryUsage memoryUsage() const {
+		MemoryUsage usage;
+
+		usage.stateBytes = sizeof(CelestialTimepiece);
+
+		return usage;
+	}
+
+	// Changes whenever clocks are added to or removed from this timepiece or any it holds, or any clock's day length changes
+	virtual size_t getRevision() const { return 0; }
+
+	/* Adds the clocks that tick, and the counters of the timepieces that hold them, to a tick plan. A
+	   plan only ticks CelestialDayClocks, so a timepiece that cannot be expressed as them throws */
+	virtual void compileTickPlan(TickPlan&) {
+		throw std::runtime_error("Timepiece cannot be compiled into a tick plan");
+	}
+
 	virtual void tick() = 0;
+
+protected:
+	// Every timepiece draws revisions from one counter, so the newest revision in a hierarchy only ever increases
+	static size_t nextRevision() {
+		static std::atomic<size_t> lastRevision = 0;
+
+		return ++lastRevision;
+	}
+
+	// The revision taken by the newest change to any clock's day length. Day lengths change rarely, so
+	// timepieces fold it into their own revisions instead of tracking which clocks changed
+	static std::atomic<size_t>& lastProfileRevision() {
+		static std::atomic<size_t> profileRevision = 0;
+
+		return profileRevision;
+	}
 };
 
 #endif
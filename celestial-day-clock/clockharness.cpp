@@ -0,0 +1,154 @@
+#include "clockharness.h"
+#include "dayphase.h"
+#include "offsetclockview.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr int maxSmallBodyHours = 40;
+static constexpr int maxLargeBodyHours = 6000;
+static constexpr int maxBodyMinutes = 130;
+
+static int randomBetween(int low, int high) { return low + std::rand() % (high - low + 1); }
+
+static bool isCanonical(const CelestialDayClock& clock) {
+	return clock.getHours() >= 0 && clock.getHours() <= clock.getProfile().maxHours &&
+		clock.getMinutesDigit1() < CelestialDayClock::radix &&
+		clock.getMinutesDigit2() < CelestialDayClock::secondaryRadix &&
+		clock.getSecondsDigit1() < CelestialDayClock::radix &&
+		clock.getSecondsDigit2() < CelestialDayClock::secondaryRadix;
+}
+
+static bool isFormattingConsistent(const CelestialDayClock& clock) {
+	char time[CelestialDayClock::maxTimeLength];
+
+	return clock.getTime() == std::string(time, clock.formatTime(time)) &&
+		clock.getTimeMilitary() == std::string(time, clock.formatTimeMilitary(time));
+}
+
+static bool isSameTime(const CelestialDayClock& clock, const CelestialDayClock& reference) {
+	return clock.getProfileId() == reference.getProfileId() &&
+		clock.getTimeMilitary() == reference.getTimeMilitary() && clock.getTime() == reference.getTime() &&
+		clock.getSecondsOfDay() == reference.getSecondsOfDay();
+}
+
+ClockCase ClockCase::random() {
+	ClockCase clockCase;
+	const int shape = std::rand() % 4;
+
+	// Odd hours and minutes around twice halfMaxBodyMinutes are where setBodyMaximums normalizes
+	clockCase.bodyMaxHours = shape == 0 ? randomBetween(-2, maxLargeBodyHours) : randomBetween(-2, maxSmallBodyHours);
+	clockCase.bodyMaxMinutes = shape == 1 ? randomBetween(54, 62) : randomBetween(-4, maxBodyMinutes);
+
+	const CelestialDayClock clock(clockCase.bodyMaxHours, clockCase.bodyMaxMinutes);
+	const DayProfile& profile = clock.getProfile();
+	const int edges[] = { 0, profile.halfDaySeconds - 1, profile.halfDaySeconds, profile.daySeconds - 1 };
+	const int start = std::rand() % 3 == 0 ? edges[std::rand() % 4] : std::rand() % profile.daySeconds;
+
+	clockCase.startSecondsOfDay = start;
+	clockCase.ticks = static_cast<std::uint32_t>(std::rand() % 2 == 0 ? randomBetween(0, 3) :
+		std::rand() % std::min<int>(maxTicks, 2 * profile.daySeconds + 2));
+
+	return clockCase;
+}
+
+ClockCase ClockCase::fromBytes(const std::uint8_t* data, size_t size) {
+	std::uint8_t bytes[12] = {};
+	ClockCase clockCase;
+
+	if (size > 0) std::memcpy(bytes, data, std::min(size, sizeof(bytes)));
+	clockCase.bodyMaxHours = static_cast<std::int16_t>(bytes[0] | bytes[1] << 8) % (maxLargeBodyHours + 1);
+	clockCase.bodyMaxMinutes = static_cast<std::int8_t>(bytes[2]);
+	clockCase.startSecondsOfDay = static_cast<int>((bytes[3] | bytes[4] << 8 | bytes[5] << 16 | bytes[6] << 24) & 0x7fffffff);
+	clockCase.ticks = (bytes[7] | bytes[8] << 8 | bytes[9] << 16 | static_cast<std::uint32_t>(bytes[10]) << 24) % (maxTicks + 1);
+
+	return clockCase;
+}
+
+std::string ClockCase::describe() const {
+	return "body maximums " + std::to_string(bodyMaxHours) + "h " + std::to_string(bodyMaxMinutes) +
+		"m, start " + std::to_string(startSecondsOfDay) + "s, " + std::to_string(ticks) + " ticks";
+}
+
+ClockHarness::ClockHarness() {
+	add("seconds of day", [](const CelestialDayClock& start, std::uint64_t ticks) {
+		CelestialDayClock clock = start;
+
+		clock.setSecondsOfDay(static_cast<int>((start.getSecondsOfDay() + ticks) % start.getProfile().daySeconds));
+
+		return clock;
+		});
+
+	add("day phase", [](const CelestialDayClock& start, std::uint64_t ticks) {
+		const DayProfile& profile = start.getProfile();
+		CelestialDayClock clock = start;
+
+		clock.setDayPhase(DayPhase::fromSecondsOfDay(
+			static_cast<int>((start.getSecondsOfDay() + ticks) % profile.daySeconds), profile));
+
+		return clock;
+		});
+
+	add("offset view", [](const CelestialDayClock& start, std::uint64_t ticks) {
+		const OffsetClockView view(start, static_cast<int>(ticks % start.getProfile().daySeconds));
+
+		return CelestialDayClock(view);
+		});
+}
+
+void ClockHarness::add(const std::string& name, Engine engine) { engines.emplace_back(name, std::move(engine)); }
+
+bool ClockHarness::check(const ClockCase& clockCase, std::string& failure) const {
+	CelestialDayClock reference(clockCase.bodyMaxHours, clockCase.bodyMaxMinutes);
+	const int daySeconds = reference.getProfile().daySeconds;
+
+	reference.setSecondsOfDay(clockCase.startSecondsOfDay);
+
+	const CelestialDayClock start = reference;
+
+	if (!isCanonical(start) || start.getSecondsOfDay() != clockCase.startSecondsOfDay % daySeconds) {
+		failure = "Setting seconds of day is not exact for " + clockCase.describe();
+
+		return false;
+	}
+
+	for (std::uint32_t tick = 0; tick < clockCase.ticks; ++tick) {
+		const int secondsOfDay = reference.getSecondsOfDay();
+
+		reference.tick();
+
+		if (reference.getSecondsOfDay() != (secondsOfDay + 1) % daySeconds || !isCanonical(reference)) {
+			failure = "Tick " + std::to_string(tick) + " from " + reference.getTimeMilitary() +
+				" does not advance one second for " + clockCase.describe();
+
+			return false;
+		}
+	}
+
+	if (!isFormattingConsistent(reference)) {
+		failure = "Formatting differs at " + reference.getTimeMilitary() + " for " + clockCase.describe();
+
+		return false;
+	}
+
+	for (const auto& [name, engine] : engines) {
+		const CelestialDayClock clock = engine(start, clockCase.ticks);
+
+		if (!isSameTime(clock, reference)) {
+			failure = "Engine " + name + " reached " + clock.getTimeMilitary() + " instead of " +
+				reference.getTimeMilitary() + " for " + clockCase.describe();
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t ClockHarness::checkRandom(size_t caseCount, std::string& failure) const {
+	for (size_t caseIndex = 0; caseIndex < caseCount; ++caseIndex) {
+		if (!check(ClockCase::random(), failure)) return caseIndex;
+	}
+
+	return caseCount;
+}
@@ -0,0 +1,50 @@
+#ifndef CLOCK_HARNESS_H
+#define CLOCK_HARNESS_H
+
+#include "celestialdayclock.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A day shape, a starting second of day and a number of ticks to run every clock engine through
+struct ClockCase {
+	static constexpr std::uint32_t maxTicks = 1 << 18;
+
+	int bodyMaxHours = 0;
+	int bodyMaxMinutes = 0;
+	int startSecondsOfDay = 0;
+	std::uint32_t ticks = 0;
+
+	static ClockCase random();
+
+	static ClockCase fromBytes(const std::uint8_t* data, size_t size);
+
+	std::string describe() const;
+};
+
+/* A differential harness that runs a clock case through the reference CelestialDayClock::tick and
+   through every registered engine, which must reach the same time in one step. It also checks the
+   properties each reference tick must keep: one second forward, digits in range and fast
+   formatting that matches the string formatting */
+class ClockHarness {
+public:
+	using Engine = std::function<CelestialDayClock(const CelestialDayClock& start, std::uint64_t ticks)>;
+
+	ClockHarness();
+
+	void add(const std::string& name, Engine engine);
+
+	size_t getEngineCount() const { return engines.size(); }
+
+	bool check(const ClockCase& clockCase, std::string& failure) const;
+
+	size_t checkRandom(size_t caseCount, std::string& failure) const;
+
+private:
+	std::vector<std::pair<std::string, Engine>> engines;
+};
+
+#endif
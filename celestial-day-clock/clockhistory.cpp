@@ -0,0 +1,297 @@
+#include "clockhistory.h"
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+ClockHistory::ClockHistory(GalacticTimepiece& timepiece, size_t capacity) : timepiece(timepiece), capacity(capacity) {
+	if (capacity == 0) throw std::invalid_argument("History capacity must be positive");
+
+	ClockSnapshot clockSnapshot;
+
+	frames.resize(capacity);
+	timepiece.snapshot(clockSnapshot);
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		record(clockSnapshot, timepiece.getRevision());
+	}
+
+	// Diffing every clock against the previous tick adds one pass over the galaxy to each tick
+	tickListenerId = timepiece.addTickListener([this](std::uint64_t tick) { capture(tick); });
+}
+
+ClockHistory::~ClockHistory() { timepiece.removeTickListener(tickListenerId); }
+
+size_t ClockHistory::getSize() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return size;
+}
+
+std::uint64_t ClockHistory::getOldestTick() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return size == 0 ? 0 : getFrame(0).tick;
+}
+
+std::uint64_t ClockHistory::getNewestTick() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return size == 0 ? 0 : getFrame(size - 1).tick;
+}
+
+size_t ClockHistory::getKeyframeCount() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return keyframeCount;
+}
+
+size_t ClockHistory::getDeltaCount() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return deltaCount;
+}
+
+bool ClockHistory::at(std::uint64_t tick, ClockSnapshot& clockSnapshot) const { return load(tick, clockSnapshot) != nullptr; }
+
+bool ClockHistory::ago(std::uint64_t seconds, ClockSnapshot& clockSnapshot) const {
+	const std::uint64_t newestTick = getNewestTick();
+
+	return seconds <= newestTick && at(newestTick - seconds, clockSnapshot);
+}
+
+bool ClockHistory::getTimesMilitary(std::uint64_t tick, std::vector<std::string>& times) const {
+	return getTimes(tick, times, true);
+}
+
+bool ClockHistory::getTimes(std::uint64_t tick, std::vector<std::string>& times) const {
+	return getTimes(tick, times, false);
+}
+
+MemoryUsage ClockHistory::memoryUsage() const {
+	std::lock_guard<std::mutex> lock(mtx);
+	std::unordered_set<const Layout*> layouts = { layout.get() };
+	MemoryUsage usage;
+
+	usage.stateBytes = sizeof(ClockHistory);
+	usage.addVector(frames);
+	usage.addVector(previousSecondsOfDay);
+	usage.addVector(captured.profileIds);
+	usage.addVector(captured.secondsOfDay);
+
+	for (size_t position = 0; position < size; ++position) {
+		const Frame& frame = getFrame(position);
+
+		usage.addVector(frame.deltas);
+
+		if (frame.keyframe) {
+			usage.containerBytes += sizeof(Keyframe);
+			usage.addAllocation(sizeof(Keyframe));
+			usage.addVector(frame.keyframe->secondsOfDay);
+			layouts.insert(frame.keyframe->layout.get());
+		}
+	}
+
+	for (const Layout* frameLayout : layouts) {
+		if (frameLayout == nullptr) continue;
+
+		usage.containerBytes += sizeof(Layout);
+		usage.addAllocation(sizeof(Layout));
+		usage.addVector(frameLayout->profileIds);
+		usage.addVector(frameLayout->daySeconds);
+		usage.addVector(frameLayout->labels);
+
+		for (const std::string& label : frameLayout->labels) usage.labelBytes += label.size();
+	}
+
+	return usage;
+}
+
+void ClockHistory::capture(std::uint64_t tick) {
+	captured.tick = tick;
+	captured.profileIds.clear();
+	captured.secondsOfDay.clear();
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+		orreryTimepiece.syncViews();
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index) {
+			const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+
+			captured.profileIds.push_back(clock.getProfileId());
+			captured.secondsOfDay.push_back(clock.getSecondsOfDay());
+		}
+	}
+
+	const size_t revision = timepiece.getRevision();
+	std::lock_guard<std::mutex> lock(mtx);
+
+	record(captured, revision);
+}
+
+void ClockHistory::record(const ClockSnapshot& clockSnapshot, size_t revision) {
+	const bool isLayoutChanged = !layout || layout->revision != revision;
+
+	if (isLayoutChanged) {
+		std::shared_ptr<Layout> newLayout = std::make_shared<Layout>();
+
+		newLayout->revision = revision;
+		newLayout->profileIds = clockSnapshot.profileIds;
+
+		for (const DayProfile::Id profileId : clockSnapshot.profileIds)
+			newLayout->daySeconds.push_back(DayProfile::get(profileId).daySeconds);
+
+		if (layout && layout->revision == revision) {
+			newLayout->labels = layout->labels;
+		}
+		else {
+			for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+				const std::string orreryLabel(timepiece.getLabelAt(orreryIndex));
+				const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+				for (size_t index = 0; index < orreryTimepiece.getSize(); ++index)
+					newLayout->labels.push_back(orreryLabel + std::string(orreryTimepiece.getLabelAt(index)));
+			}
+		}
+
+		layout = std::move(newLayout);
+	}
+
+	if (size == capacity) evictOldest();
+
+	const bool isKeyframe = size == 0 || isLayoutChanged || clockSnapshot.tick != getFrame(size - 1).tick + 1 ||
+		clockSnapshot.tick - lastKeyframeTick >= keyframeInterval;
+	Frame& frame = getFrame(size);
+
+	frame.tick = clockSnapshot.tick;
+	frame.keyframe.reset();
+	frame.deltas.clear();
+
+	if (isKeyframe) {
+		frame.keyframe = std::make_shared<const Keyframe>(Keyframe{ layout, clockSnapshot.secondsOfDay });
+		lastKeyframeTick = clockSnapshot.tick;
+		++keyframeCount;
+	}
+	else {
+		for (size_t index = 0; index < clockSnapshot.getSize(); ++index) {
+			const int expected = previousSecondsOfDay[index] + 1 == layout->daySeconds[index] ? 0 :
+				previousSecondsOfDay[index] + 1;
+
+			if (clockSnapshot.secondsOfDay[index] != expected)
+				frame.deltas.push_back({ static_cast<std::uint32_t>(index), clockSnapshot.secondsOfDay[index] });
+		}
+
+		deltaCount += frame.deltas.size();
+	}
+
+	previousSecondsOfDay = clockSnapshot.secondsOfDay;
+	++size;
+}
+
+// The oldest frame is always a keyframe, so the frame after it becomes one before it is dropped
+void ClockHistory::evictOldest() {
+	if (size > 1 && !getFrame(1).keyframe) {
+		std::shared_ptr<Keyframe> keyframe = std::make_shared<Keyframe>();
+		Frame& next = getFrame(1);
+
+		keyframe->layout = rebuild(1, keyframe->secondsOfDay);
+		deltaCount -= next.deltas.size();
+		next.deltas.clear();
+		next.keyframe = std::move(keyframe);
+		++keyframeCount;
+	}
+
+	Frame& frame = getFrame(0);
+
+	if (frame.keyframe) --keyframeCount;
+
+	deltaCount -= frame.deltas.size();
+	frame = Frame();
+	oldest = (oldest + 1) % capacity;
+	--size;
+}
+
+bool ClockHistory::find(std::uint64_t tick, size_t& position) const {
+	size_t low = 0;
+	size_t high = size;
+
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+
+		if (getFrame(middle).tick < tick) low = middle + 1;
+		else high = middle;
+	}
+
+	position = low;
+
+	return low < size && getFrame(low).tick == tick;
+}
+
+// Each clock advances one second per tick from the last value a keyframe or delta gave it
+std::shared_ptr<const ClockHistory::Layout> ClockHistory::rebuild(size_t position, std::vector<int>& secondsOfDay) const {
+	size_t keyPosition = position;
+
+	while (!getFrame(keyPosition).keyframe) --keyPosition;
+
+	const Keyframe& keyframe = *getFrame(keyPosition).keyframe;
+	const std::uint64_t tick = getFrame(position).tick;
+	std::vector<std::uint64_t> baseTicks(keyframe.secondsOfDay.size(), getFrame(keyPosition).tick);
+
+	secondsOfDay = keyframe.secondsOfDay;
+
+	for (size_t deltaPosition = keyPosition + 1; deltaPosition <= position; ++deltaPosition) {
+		const Frame& frame = getFrame(deltaPosition);
+
+		for (const Delta& delta : frame.deltas) {
+			secondsOfDay[delta.clockIndex] = delta.secondsOfDay;
+			baseTicks[delta.clockIndex] = frame.tick;
+		}
+	}
+
+	for (size_t index = 0; index < secondsOfDay.size(); ++index) {
+		const std::uint64_t daySeconds = static_cast<std::uint64_t>(keyframe.layout->daySeconds[index]);
+
+		secondsOfDay[index] = static_cast<int>((secondsOfDay[index] + (tick - baseTicks[index]) % daySeconds) % daySeconds);
+	}
+
+	return keyframe.layout;
+}
+
+std::shared_ptr<const ClockHistory::Layout> ClockHistory::load(std::uint64_t tick, ClockSnapshot& clockSnapshot) const {
+	std::lock_guard<std::mutex> lock(mtx);
+	size_t position = 0;
+
+	if (!find(tick, position)) return nullptr;
+
+	std::shared_ptr<const Layout> frameLayout = rebuild(position, clockSnapshot.secondsOfDay);
+
+	clockSnapshot.tick = tick;
+	clockSnapshot.profileIds = frameLayout->profileIds;
+
+	return frameLayout;
+}
+
+bool ClockHistory::getTimes(std::uint64_t tick, std::vector<std::string>& times, bool isMilitary) const {
+	ClockSnapshot clockSnapshot;
+	const std::shared_ptr<const Layout> frameLayout = load(tick, clockSnapshot);
+	std::unordered_map<DayProfile::Id, CelestialDayClock> clocks;
+	char time[CelestialDayClock::maxTimeLength];
+
+	if (!frameLayout) return false;
+
+	times.resize(clockSnapshot.getSize());
+
+	for (size_t index = 0; index < clockSnapshot.getSize(); ++index) {
+		const DayProfile& profile = DayProfile::get(clockSnapshot.profileIds[index]);
+		CelestialDayClock& clock = clocks.try_emplace(clockSnapshot.profileIds[index],
+			profile.bodyMaxHours, profile.bodyMaxMinutes).first->second;
+
+		clock.setSecondsOfDay(clockSnapshot.secondsOfDay[index]);
+		times[index].assign(frameLayout->labels[index]);
+		times[index].append(time, isMilitary ? clock.formatTimeMilitary(time) : clock.formatTime(time));
+	}
+
+	return true;
+}
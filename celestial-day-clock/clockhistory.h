@@ -0,0 +1,112 @@
+#ifndef CLOCK_HISTORY_H
+#define CLOCK_HISTORY_H
+
+#include "celestialdayclock.h"
+#include "clocksnapshot.h"
+#include "galactictimepiece.h"
+#include "memoryusage.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* A bounded ring of a galactic timepiece's clock states at its most recent ticks. Every tick
+   advances each clock by one second, so a tick is stored as the few clocks that did anything else,
+   with a full keyframe at regular intervals and whenever clocks are added or removed. A past tick
+   is rebuilt from the keyframe before it and the deltas since, without replaying the galaxy */
+class ClockHistory {
+public:
+	static constexpr size_t defaultCapacity = 3600;
+	static constexpr std::uint64_t keyframeInterval = 64;
+
+	explicit ClockHistory(GalacticTimepiece& timepiece, size_t capacity = defaultCapacity);
+
+	~ClockHistory();
+
+	ClockHistory(const ClockHistory&) = delete;
+
+	ClockHistory& operator=(const ClockHistory&) = delete;
+
+	size_t getCapacity() const { return capacity; }
+
+	size_t getSize() const;
+
+	std::uint64_t getOldestTick() const;
+
+	std::uint64_t getNewestTick() const;
+
+	size_t getKeyframeCount() const;
+
+	size_t getDeltaCount() const;
+
+	bool at(std::uint64_t tick, ClockSnapshot& clockSnapshot) const;
+
+	bool ago(std::uint64_t seconds, ClockSnapshot& clockSnapshot) const;
+
+	bool getTimesMilitary(std::uint64_t tick, std::vector<std::string>& times) const;
+
+	bool getTimes(std::uint64_t tick, std::vector<std::string>& times) const;
+
+	MemoryUsage memoryUsage() const;
+
+private:
+	// The clocks' profiles and labels, which only change when the galaxy's revision does
+	struct Layout {
+		size_t revision = 0;
+		std::vector<DayProfile::Id> profileIds;
+		std::vector<int> daySeconds;
+		std::vector<std::string> labels;
+	};
+
+	struct Keyframe {
+		std::shared_ptr<const Layout> layout;
+		std::vector<int> secondsOfDay;
+	};
+
+	struct Delta {
+		std::uint32_t clockIndex;
+		std::int32_t secondsOfDay;
+	};
+
+	struct Frame {
+		std::uint64_t tick = 0;
+		std::shared_ptr<const Keyframe> keyframe;
+		std::vector<Delta> deltas;
+	};
+
+	GalacticTimepiece& timepiece;
+	mutable std::mutex mtx;
+	std::vector<Frame> frames;
+	std::shared_ptr<const Layout> layout;
+	std::vector<int> previousSecondsOfDay;
+	ClockSnapshot captured;
+	size_t capacity;
+	size_t oldest = 0;
+	size_t size = 0;
+	size_t keyframeCount = 0;
+	size_t deltaCount = 0;
+	std::uint64_t lastKeyframeTick = 0;
+	size_t tickListenerId = 0;
+
+	void capture(std::uint64_t tick);
+
+	void record(const ClockSnapshot& clockSnapshot, size_t revision);
+
+	void evictOldest();
+
+	const Frame& getFrame(size_t position) const { return frames[(oldest + position) % capacity]; }
+
+	Frame& getFrame(size_t position) { return frames[(oldest + position) % capacity]; }
+
+	bool find(std::uint64_t tick, size_t& position) const;
+
+	std::shared_ptr<const Layout> rebuild(size_t position, std::vector<int>& secondsOfDay) const;
+
+	std::shared_ptr<const Layout> load(std::uint64_t tick, ClockSnapshot& clockSnapshot) const;
+
+	bool getTimes(std::uint64_t tick, std::vector<std::string>& times, bool isMilitary) const;
+};
+
+#endif
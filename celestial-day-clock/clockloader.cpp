@@ -0,0 +1,318 @@
+#include "clockloader.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+static constexpr size_t minChunkBytes = 1024 * 1024;
+static constexpr size_t fieldCount = 5;
+
+// A parsed line that still points into the loaded text for its orrery label
+struct ClockRecord {
+	std::string_view orreryLabel;
+	LabelPool::Id label;
+	DayProfile::Id profileId;
+	int secondsOfDay;
+};
+
+struct ClockChunk {
+	std::vector<ClockRecord> records;
+	size_t lineCount = 0;
+	size_t errorLine = 0;
+	std::string error;
+};
+
+static bool parseInt(std::string_view field, int& value) {
+	const char* const end = field.data() + field.size();
+	const std::from_chars_result result = std::from_chars(field.data(), end, value);
+
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+// Lines and fields are found with memchr, which the C library vectorizes
+static void parseChunk(std::string_view text, ClockChunk& chunk) {
+	std::unordered_map<std::string_view, LabelPool::Id> labels;
+	std::map<std::pair<int, int>, DayProfile::Id> profiles;
+	const char* position = text.data();
+	const char* const end = text.data() + text.size();
+
+	while (position < end) {
+		const char* newline = static_cast<const char*>(std::memchr(position, '\n', static_cast<size_t>(end - position)));
+		const char* const lineEnd = newline == nullptr ? end : newline;
+		std::string_view line(position, static_cast<size_t>(lineEnd - position));
+		std::string_view fields[fieldCount];
+		size_t count = 0;
+
+		++chunk.lineCount;
+		position = newline == nullptr ? end : newline + 1;
+
+		if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+		if (line.empty() || line.front() == '#') continue;
+
+		while (count < fieldCount) {
+			const char* const comma = static_cast<const char*>(std::memchr(line.data(), ',', line.size()));
+
+			if (comma == nullptr) {
+				fields[count++] = line;
+				line = {};
+				break;
+			}
+
+			fields[count++] = line.substr(0, static_cast<size_t>(comma - line.data()));
+			line.remove_prefix(static_cast<size_t>(comma - line.data()) + 1);
+		}
+
+		int hours = 0;
+		int minutes = 0;
+		int secondsOfDay = 0;
+
+		if (count < fieldCount - 1 || !line.empty() || !parseInt(fields[2], hours) || !parseInt(fields[3], minutes) ||
+			(count == fieldCount && !parseInt(fields[4], secondsOfDay))) {
+			chunk.errorLine = chunk.lineCount;
+			chunk.error = "expected orrery,clock,hours,minutes[,seconds of day]";
+			return;
+		}
+
+		auto label = labels.find(fields[1]);
+
+		if (label == labels.end()) label = labels.emplace(fields[1], LabelPool::intern(fields[1])).first;
+
+		auto profile = profiles.find({ hours, minutes });
+
+		if (profile == profiles.end())
+			profile = profiles.emplace(std::make_pair(hours, minutes), DayProfile::fromBodyMaximums(hours, minutes)).first;
+
+		chunk.records.push_back({ fields[0], label->second, profile->second, secondsOfDay });
+	}
+}
+
+// Each orrery is built by one thread, copying a prototype clock per day profile into its slabs
+static void buildOrreries(const std::vector<ClockRecord>& records, const std::vector<size_t>& order,
+	const std::vector<size_t>& orreryStarts, std::vector<std::unique_ptr<OrreryTimepiece>>& orreries,
+	size_t firstOrrery, size_t lastOrrery) {
+	std::unordered_map<DayProfile::Id, CelestialDayClock> prototypes;
+	std::vector<LabelPool::Id> labels;
+
+	for (size_t orreryIndex = firstOrrery; orreryIndex < lastOrrery; ++orreryIndex) {
+		const size_t begin = orreryStarts[orreryIndex];
+		const size_t end = orreryStarts[orreryIndex + 1];
+		std::unique_ptr<OrreryTimepiece> orrery = std::make_unique<OrreryTimepiece>();
+
+		labels.clear();
+
+		for (size_t index = begin; index < end; ++index) labels.push_back(records[order[index]].label);
+
+		std::sort(labels.begin(), labels.end());
+
+		const auto duplicate = std::adjacent_find(labels.begin(), labels.end());
+
+		if (duplicate != labels.end())
+			throw std::runtime_error("Duplicate clock label " + std::string(LabelPool::get(*duplicate)) +
+				" in orrery " + std::string(records[order[begin]].orreryLabel));
+
+		orrery->reserve(end - begin);
+
+		for (size_t index = begin; index < end; ++index) {
+			const ClockRecord& record = records[order[index]];
+			auto prototype = prototypes.find(record.profileId);
+
+			if (prototype == prototypes.end()) {
+				const DayProfile& profile = DayProfile::get(record.profileId);
+
+				prototype = prototypes.emplace(record.profileId, CelestialDayClock(profile.bodyMaxHours, profile.bodyMaxMinutes)).first;
+			}
+
+			orrery->emplaceUnchecked(record.label, prototype->second)->setSecondsOfDay(record.secondsOfDay);
+		}
+
+		orreries[orreryIndex] = std::move(orrery);
+	}
+}
+
+GalacticTimepiece* ClockLoader::load(std::string_view text, size_t threadCount) {
+	if (threadCount == 0) threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+	// Chunks end on line boundaries, so every chunk parses independently
+	std::vector<std::string_view> chunkTexts;
+	const size_t chunkBytes = std::max(minChunkBytes, text.size() / threadCount + 1);
+
+	for (size_t begin = 0; begin < text.size();) {
+		size_t end = std::min(begin + chunkBytes, text.size());
+		const char* const newline = end == text.size() ? nullptr :
+			static_cast<const char*>(std::memchr(text.data() + end, '\n', text.size() - end));
+
+		end = newline == nullptr ? text.size() : static_cast<size_t>(newline - text.data()) + 1;
+		chunkTexts.push_back(text.substr(begin, end - begin));
+		begin = end;
+	}
+
+	std::vector<ClockChunk> chunks(chunkTexts.size());
+	std::vector<std::future<void>> parsers;
+
+	for (size_t chunkIndex = 1; chunkIndex < chunks.size(); ++chunkIndex)
+		parsers.push_back(std::async(std::launch::async, parseChunk, chunkTexts[chunkIndex], std::ref(chunks[chunkIndex])));
+
+	if (!chunks.empty()) parseChunk(chunkTexts[0], chunks[0]);
+
+	for (std::future<void>& parser : parsers) parser.get();
+
+	size_t firstLine = 0;
+	size_t recordCount = 0;
+
+	for (const ClockChunk& chunk : chunks) {
+		if (chunk.errorLine != 0)
+			throw std::runtime_error("Invalid clock definition on line " + std::to_string(firstLine + chunk.errorLine) +
+				": " + chunk.error);
+
+		firstLine += chunk.lineCount;
+		recordCount += chunk.records.size();
+	}
+
+	std::vector<ClockRecord> records;
+
+	records.reserve(recordCount);
+
+	for (ClockChunk& chunk : chunks) {
+		records.insert(records.end(), chunk.records.begin(), chunk.records.end());
+		std::vector<ClockRecord>().swap(chunk.records);
+	}
+
+	// Records are grouped by orrery with a counting sort that keeps each orrery's clocks in file order
+	std::unordered_map<std::string_view, size_t> orreryIndices;
+	std::vector<std::string_view> orreryLabels;
+	std::vector<size_t> recordOrreries(records.size());
+	std::vector<size_t> orreryStarts;
+
+	for (size_t index = 0; index < records.size(); ++index) {
+		const std::string_view orreryLabel = records[index].orreryLabel;
+
+		if (index > 0 && orreryLabel == records[index - 1].orreryLabel) {
+			recordOrreries[index] = recordOrreries[index - 1];
+		}
+		else {
+			const auto orrery = orreryIndices.emplace(orreryLabel, orreryLabels.size()).first;
+
+			if (orrery->second == orreryLabels.size()) orreryLabels.push_back(orreryLabel);
+
+			recordOrreries[index] = orrery->second;
+		}
+	}
+
+	orreryStarts.assign(orreryLabels.size() + 1, 0);
+
+	for (const size_t orreryIndex : recordOrreries) ++orreryStarts[orreryIndex + 1];
+
+	for (size_t orreryIndex = 0; orreryIndex < orreryLabels.size(); ++orreryIndex)
+		orreryStarts[orreryIndex + 1] += orreryStarts[orreryIndex];
+
+	std::vector<size_t> order(records.size());
+	std::vector<size_t> nextPositions(orreryStarts.begin(), orreryStarts.end() - 1);
+
+	for (size_t index = 0; index < records.size(); ++index) order[nextPositions[recordOrreries[index]]++] = index;
+
+	std::vector<std::unique_ptr<OrreryTimepiece>> orreries(orreryLabels.size());
+	std::vector<std::future<void>> builders;
+	const size_t builderCount = std::min(threadCount, orreries.size());
+
+	for (size_t builder = 1; builder < builderCount; ++builder) {
+		builders.push_back(std::async(std::launch::async, buildOrreries, std::cref(records), std::cref(order),
+			std::cref(orreryStarts), std::ref(orreries), orreries.size() * builder / builderCount,
+			orreries.size() * (builder + 1) / builderCount));
+	}
+
+	std::exception_ptr error;
+
+	try {
+		buildOrreries(records, order, orreryStarts, orreries, 0, builderCount == 0 ? 0 : orreries.size() / builderCount);
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+
+	for (std::future<void>& builder : builders) {
+		try {
+			builder.get();
+		}
+		catch (...) {
+			if (!error) error = std::current_exception();
+		}
+	}
+
+	if (error) std::rethrow_exception(error);
+
+	std::unique_ptr<GalacticTimepiece> timepiece = std::make_unique<GalacticTimepiece>();
+
+	for (size_t orreryIndex = 0; orreryIndex < orreries.size(); ++orreryIndex)
+		timepiece->add(std::string(orreryLabels[orreryIndex]), orreries[orreryIndex].release());
+
+	return timepiece.release();
+}
+
+GalacticTimepiece* ClockLoader::loadFile(const std::string& path, size_t threadCount) {
+#ifdef __linux__
+	const int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat status = {};
+
+	if (fileDescriptor < 0) throw std::runtime_error("Failed to open clock definitions " + path);
+
+	if (fstat(fileDescriptor, &status) < 0) {
+		close(fileDescriptor);
+		throw std::runtime_error("Failed to read clock definitions " + path);
+	}
+
+	const size_t size = static_cast<size_t>(status.st_size);
+
+	if (size == 0) {
+		close(fileDescriptor);
+		return new GalacticTimepiece();
+	}
+
+	void* const mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fileDescriptor, 0);
+
+	close(fileDescriptor);
+
+	if (mapping == MAP_FAILED) throw std::runtime_error("Failed to map clock definitions " + path);
+
+	try {
+		GalacticTimepiece* const timepiece = load(std::string_view(static_cast<const char*>(mapping), size), threadCount);
+
+		munmap(mapping, size);
+
+		return timepiece;
+	}
+	catch (...) {
+		munmap(mapping, size);
+		throw;
+	}
+#else
+	std::ifstream in(path, std::ios::binary);
+	std::ostringstream text;
+
+	if (!in) throw std::runtime_error("Failed to open clock definitions " + path);
+
+	text << in.rdbuf();
+
+	return load(text.str(), threadCount);
+#endif
+}
@@ -0,0 +1,23 @@
+#ifndef CLOCK_LOADER_H
+#define CLOCK_LOADER_H
+
+#include "galactictimepiece.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/* Builds a galactic timepiece from clock definitions, one per line:
+   orrery label,clock label,hours,minutes[,seconds of day]
+   Hours and minutes are the body's day length, as in planetDayLengths, and the seconds of day set
+   the clock's initial time. Labels are taken verbatim up to the next comma. Blank lines and lines
+   starting with # are skipped. Orreries appear in the order their labels first occur. Files are
+   memory mapped where possible, lines are split across threads, and clocks are copied straight
+   into their orreries' slabs without an intermediate string per record */
+class ClockLoader {
+public:
+	static GalacticTimepiece* load(std::string_view text, size_t threadCount = 0);
+
+	static GalacticTimepiece* loadFile(const std::string& path, size_t threadCount = 0);
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "clockranking.h"
+#include "dayphase.h"
+#include <algorithm>
+#include <array>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+static constexpr int digitBits = 8;
+static constexpr size_t digitCount = size_t{ 1 } << digitBits;
+static constexpr std::uint64_t halfPhase = DayPhase::one / 2;
+
+// Runs work over equal slices of [0, count), the first on the calling thread
+template<class Work>
+static void forEachSlice(size_t count, size_t sliceCount, Work work) {
+	std::vector<std::future<void>> workers;
+
+	for (size_t slice = 1; slice < sliceCount; ++slice)
+		workers.push_back(std::async(std::launch::async, work, slice, count * slice / sliceCount, count * (slice + 1) / sliceCount));
+
+	work(size_t{ 0 }, size_t{ 0 }, count / sliceCount);
+
+	for (std::future<void>& worker : workers) worker.get();
+}
+
+ClockRanking::ClockRanking(RankKey key, size_t threadCount) : key(key),
+	threadCount(threadCount == 0 ? std::max<size_t>(std::thread::hardware_concurrency(), 1) : threadCount) {}
+
+std::uint32_t ClockRanking::getKeyValue(RankKey key, int secondsOfDay, const DayProfile& profile) {
+	if (key == RankKey::SecondsOfDay) return static_cast<std::uint32_t>(secondsOfDay);
+
+	const std::uint64_t phase = DayPhase::fromSecondsOfDay(secondsOfDay, profile);
+
+	switch (key) {
+	case RankKey::DayPhase:
+		return static_cast<std::uint32_t>(phase);
+	case RankKey::MidnightDistance:
+		return static_cast<std::uint32_t>(std::min(phase, DayPhase::one - phase));
+	case RankKey::NoonDistance:
+		return static_cast<std::uint32_t>(phase > halfPhase ? phase - halfPhase : halfPhase - phase);
+	default:
+		throw std::invalid_argument("Unknown rank key");
+	}
+}
+
+const std::vector<std::uint32_t>& ClockRanking::rank(const ClockSnapshot& clockSnapshot) {
+	if (clockSnapshot.getSize() > std::numeric_limits<std::uint32_t>::max())
+		throw std::length_error("Too many clocks to rank");
+
+	items.resize(clockSnapshot.getSize());
+
+	for (size_t index = 0; index < items.size(); ++index) items[index] = index;
+
+	fillItems(clockSnapshot);
+	radixSort();
+	storeOrder();
+	displacedCount = items.size();
+	++fullSortCount;
+
+	return order;
+}
+
+const std::vector<std::uint32_t>& ClockRanking::rank(GalacticTimepiece& timepiece) {
+	timepiece.snapshot(snapshot);
+
+	return rank(snapshot);
+}
+
+const std::vector<std::uint32_t>& ClockRanking::update(const ClockSnapshot& clockSnapshot) {
+	if (items.size() != clockSnapshot.getSize() || items.empty()) return rank(clockSnapshot);
+
+	fillItems(clockSnapshot);
+
+	// Clocks that dropped below the run kept so far, or rose above their successor, are set aside
+	scratch.clear();
+	displaced.clear();
+
+	for (size_t position = 0; position < items.size(); ++position) {
+		const std::uint64_t item = items[position];
+		const bool isAfterRun = scratch.empty() || item >= scratch.back();
+		const bool isBeforeNext = position + 1 == items.size() || item <= items[position + 1];
+
+		if (isAfterRun && isBeforeNext) scratch.push_back(item);
+		else displaced.push_back(item);
+
+		if (displaced.size() > items.size() / maxDisplacedFraction) {
+			for (size_t index = 0; index < items.size(); ++index) items[index] &= std::numeric_limits<std::uint32_t>::max();
+
+			// Restoring rendered order before the sort keeps ties in rendered order
+			std::sort(items.begin(), items.end());
+			fillItems(clockSnapshot);
+			radixSort();
+			storeOrder();
+			displacedCount = displaced.size();
+			++fullSortCount;
+
+			return order;
+		}
+	}
+
+	std::sort(displaced.begin(), displaced.end());
+	std::merge(scratch.begin(), scratch.end(), displaced.begin(), displaced.end(), items.begin());
+	storeOrder();
+	displacedCount = displaced.size();
+	++incrementalCount;
+
+	return order;
+}
+
+const std::vector<std::uint32_t>& ClockRanking::update(GalacticTimepiece& timepiece) {
+	timepiece.snapshot(snapshot);
+
+	return update(snapshot);
+}
+
+// Each item packs its clock's key above its clock index, so items order by key and then by index
+void ClockRanking::fillItems(const ClockSnapshot& clockSnapshot) {
+	const size_t sliceCount = items.size() < minParallelClocks ? 1 : threadCount;
+
+	forEachSlice(items.size(), sliceCount, [this, &clockSnapshot](size_t, size_t begin, size_t end) {
+		for (size_t position = begin; position < end; ++position) {
+			const std::uint32_t index = static_cast<std::uint32_t>(items[position]);
+			const std::uint32_t value = getKeyValue(key, clockSnapshot.secondsOfDay[index],
+				DayProfile::get(clockSnapshot.profileIds[index]));
+
+			items[position] = static_cast<std::uint64_t>(value) << 32 | index;
+		}
+		});
+}
+
+// Sorts on the key bits only; items start in index order and every pass is stable
+void ClockRanking::radixSort() {
+	const size_t count = items.size();
+	const size_t sliceCount = count < minParallelClocks ? 1 : threadCount;
+	std::vector<std::array<size_t, digitCount>> counts(sliceCount);
+
+	scratch.resize(count);
+
+	for (int shift = 32; shift < 64; shift += digitBits) {
+		forEachSlice(count, sliceCount, [this, &counts, shift](size_t slice, size_t begin, size_t end) {
+			std::array<size_t, digitCount>& sliceCounts = counts[slice];
+
+			sliceCounts.fill(0);
+
+			for (size_t position = begin; position < end; ++position) ++sliceCounts[(items[position] >> shift) & (digitCount - 1)];
+			});
+
+		size_t offset = 0;
+		bool isTrivial = false;
+
+		// Each slice scatters into its own run within every digit's bucket
+		for (size_t digit = 0; digit < digitCount && !isTrivial; ++digit) {
+			size_t digitTotal = 0;
+
+			for (size_t slice = 0; slice < sliceCount; ++slice) {
+				const size_t digitSliceCount = counts[slice][digit];
+
+				counts[slice][digit] = offset;
+				offset += digitSliceCount;
+				digitTotal += digitSliceCount;
+			}
+
+			isTrivial = digitTotal == count;
+		}
+
+		if (isTrivial) continue;
+
+		forEachSlice(count, sliceCount, [this, &counts, shift](size_t slice, size_t begin, size_t end) {
+			std::array<size_t, digitCount>& offsets = counts[slice];
+
+			for (size_t position = begin; position < end; ++position)
+				scratch[offsets[(items[position] >> shift) & (digitCount - 1)]++] = items[position];
+			});
+
+		items.swap(scratch);
+	}
+}
+
+void ClockRanking::storeOrder() {
+	order.resize(items.size());
+
+	for (size_t position = 0; position < items.size(); ++position) order[position] = static_cast<std::uint32_t>(items[position]);
+}
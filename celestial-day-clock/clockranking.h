@@ -0,0 +1,69 @@
+#ifndef CLOCK_RANKING_H
+#define CLOCK_RANKING_H
+
+#include "clocksnapshot.h"
+#include "galactictimepiece.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class RankKey {
+	SecondsOfDay,
+	DayPhase,
+	MidnightDistance,
+	NoonDistance
+};
+
+/* Orders a timepiece's clocks by a numeric key taken from their state, so dashboards can list
+   bodies by time of day without rendering or parsing times. Distances to midnight and noon are
+   measured in day phase, which compares bodies with different day lengths directly. A full ranking
+   is an LSD radix sort, split across threads for large galaxies. An update reuses the previous
+   order, since one tick barely changes it: clocks that fell out of order are sorted on their own
+   and merged back, and a full sort runs only when too many moved. Ties keep clocks in rendered order */
+class ClockRanking {
+public:
+	static constexpr size_t minParallelClocks = 64 * 1024;
+	static constexpr size_t maxDisplacedFraction = 8;
+
+	explicit ClockRanking(RankKey key = RankKey::SecondsOfDay, size_t threadCount = 0);
+
+	RankKey getKey() const { return key; }
+
+	const std::vector<std::uint32_t>& getOrder() const { return order; }
+
+	std::uint64_t getFullSortCount() const { return fullSortCount; }
+
+	std::uint64_t getIncrementalCount() const { return incrementalCount; }
+
+	size_t getDisplacedCount() const { return displacedCount; }
+
+	const std::vector<std::uint32_t>& rank(const ClockSnapshot& clockSnapshot);
+
+	const std::vector<std::uint32_t>& rank(GalacticTimepiece& timepiece);
+
+	const std::vector<std::uint32_t>& update(const ClockSnapshot& clockSnapshot);
+
+	const std::vector<std::uint32_t>& update(GalacticTimepiece& timepiece);
+
+	static std::uint32_t getKeyValue(RankKey key, int secondsOfDay, const DayProfile& profile);
+
+private:
+	RankKey key;
+	size_t threadCount;
+	ClockSnapshot snapshot;
+	std::vector<std::uint64_t> items;
+	std::vector<std::uint64_t> scratch;
+	std::vector<std::uint64_t> displaced;
+	std::vector<std::uint32_t> order;
+	std::uint64_t fullSortCount = 0;
+	std::uint64_t incrementalCount = 0;
+	size_t displacedCount = 0;
+
+	void fillItems(const ClockSnapshot& clockSnapshot);
+
+	void radixSort();
+
+	void storeOrder();
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef CLOCK_SNAPSHOT_H
+#define CLOCK_SNAPSHOT_H
+
+#include "dayprofile.h"
+#include <cstdint>
+#include <vector>
+
+/* The numeric state of every clock in a timepiece, in the same order as its rendered times, taken
+   at a known tick count */
+struct ClockSnapshot {
+	std::uint64_t tick = 0;
+	std::vector<DayProfile::Id> profileIds;
+	std::vector<int> secondsOfDay;
+
+	size_t getSize() const { return secondsOfDay.size(); }
+};
+
+#endif
@@ -0,0 +1,498 @@
+#include "columnarlog.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+static void writeVarint(std::ostream& out, std::uint64_t value) {
+	while (value >= 0x80) {
+		out.put(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+
+	out.put(static_cast<char>(value));
+}
+
+static void writeSigned(std::ostream& out, std::int64_t value) {
+	writeVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+static std::uint64_t readVarint(std::istream& in) {
+	std::uint64_t value = 0;
+
+	for (int shift = 0; shift < 64; shift += 7) {
+		const int character = in.get();
+
+		if (character == std::char_traits<char>::eof())
+			throw std::runtime_error("Truncated columnar log");
+
+		value |= static_cast<std::uint64_t>(character & 0x7F) << shift;
+
+		if ((character & 0x80) == 0) return value;
+	}
+
+	throw std::runtime_error("Corrupt varint in columnar log");
+}
+
+// Reads a count that sizes an allocation, so a corrupt log cannot ask for more than a writer ever writes
+static std::uint64_t readCount(std::istream& in, std::uint64_t maxCount, const char* name) {
+	const std::uint64_t count = readVarint(in);
+
+	if (count > maxCount) throw std::runtime_error(std::string("Corrupt ") + name + " in columnar log");
+
+	return count;
+}
+
+// Grows the string only as bytes arrive, so a corrupt length fails as truncation instead of allocating
+static void readBytes(std::istream& in, std::uint64_t size, std::string& bytes) {
+	constexpr size_t chunkSize = 4096;
+
+	bytes.clear();
+
+	while (bytes.size() < size) {
+		const size_t offset = bytes.size();
+		const size_t chunk = static_cast<size_t>(std::min<std::uint64_t>(size - offset, chunkSize));
+
+		bytes.resize(offset + chunk);
+
+		if (!in.read(bytes.data() + offset, static_cast<std::streamsize>(chunk)))
+			throw std::runtime_error("Truncated columnar log");
+	}
+}
+
+static std::int64_t readSigned(std::istream& in) {
+	const std::uint64_t value = readVarint(in);
+
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// How far a clock strayed from advancing by the sample interval, folded into half a day either way
+static std::int64_t getResidual(int value, int previous, std::uint64_t interval, int daySeconds) {
+	std::int64_t residual = (static_cast<std::int64_t>(value) - previous -
+		static_cast<std::int64_t>(interval % static_cast<std::uint64_t>(daySeconds))) % daySeconds;
+
+	if (residual < 0) residual += daySeconds;
+
+	return residual > daySeconds / 2 ? residual - daySeconds : residual;
+}
+
+static int applyResidual(int previous, std::uint64_t interval, std::int64_t residual, int daySeconds) {
+	std::int64_t value = (static_cast<std::int64_t>(previous) +
+		static_cast<std::int64_t>(interval % static_cast<std::uint64_t>(daySeconds)) + residual) % daySeconds;
+
+	if (value < 0) value += daySeconds;
+
+	return static_cast<int>(value);
+}
+
+static void writeCsvLabel(std::ostream& out, const std::string& label) {
+	size_t size = label.size();
+
+	while (size > 0 && (label[size - 1] == ' ' || label[size - 1] == ':')) --size;
+
+	const std::string_view trimmed(label.data(), size);
+
+	if (trimmed.find_first_of(",\"\r\n") == std::string_view::npos) {
+		out << trimmed;
+		return;
+	}
+
+	out.put('"');
+
+	for (const char character : trimmed) {
+		if (character == '"') out.put('"');
+
+		out.put(character);
+	}
+
+	out.put('"');
+}
+
+ColumnarLogWriter::ColumnarLogWriter(GalacticTimepiece& timepiece, std::ostream& out, std::uint64_t interval,
+	size_t blockSamples) : timepiece(timepiece), out(out), interval(interval), blockSamples(blockSamples) {
+	if (interval == 0) throw std::invalid_argument("Columnar log interval must be at least one tick");
+
+	if (blockSamples == 0) throw std::invalid_argument("Columnar log blocks must hold at least one sample");
+
+	if (blockSamples > maxBlockSamples) throw std::invalid_argument("Columnar log blocks are too large");
+
+	out.write(magic, sizeof(magic));
+	out.put(static_cast<char>(version));
+	writerThread = std::thread(&ColumnarLogWriter::writeBlocks, this);
+
+	// Sampled ticks only copy seconds of day, as blocks are encoded on the writer thread outside the tick
+	tickListenerId = timepiece.addTickListener([this](std::uint64_t tick) {
+		if (tick % this->interval == 0) capture(tick);
+		});
+}
+
+ColumnarLogWriter::~ColumnarLogWriter() {
+	timepiece.removeTickListener(tickListenerId);
+
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+
+		enqueueBlock();
+		isStopping = true;
+	}
+
+	queued.notify_one();
+	writerThread.join();
+	out.flush();
+}
+
+std::uint64_t ColumnarLogWriter::getSampleCount() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return sampleCount;
+}
+
+std::uint64_t ColumnarLogWriter::getBlockCount() const {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return blockCount;
+}
+
+void ColumnarLogWriter::flush() {
+	std::unique_lock<std::mutex> lock(mtx);
+
+	enqueueBlock();
+	written.wait(lock, [this] { return blocks.empty() && !isWriting; });
+
+	// The writer thread only touches the stream while it is writing, so the stream is ours here
+	out.flush();
+
+	if (!out) throw std::runtime_error("Failed to write columnar log");
+}
+
+void ColumnarLogWriter::capture(std::uint64_t tick) {
+	captured.tick = tick;
+	captured.profileIds.clear();
+	captured.secondsOfDay.clear();
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+		orreryTimepiece.syncViews();
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index) {
+			const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+
+			captured.profileIds.push_back(clock.getProfileId());
+			captured.secondsOfDay.push_back(clock.getSecondsOfDay());
+		}
+	}
+
+	const size_t revision = timepiece.getRevision();
+	std::lock_guard<std::mutex> lock(mtx);
+	const bool isLayoutChanged = !dictionary || dictionary->revision != revision;
+
+	if (block && (isLayoutChanged || tick != block->lastTick + interval)) enqueueBlock();
+
+	if (isLayoutChanged) {
+		std::shared_ptr<Dictionary> newDictionary = std::make_shared<Dictionary>();
+
+		newDictionary->revision = revision;
+		newDictionary->profileIds = captured.profileIds;
+
+		if (dictionary && dictionary->revision == revision) {
+			newDictionary->labels = dictionary->labels;
+		}
+		else {
+			for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+				const std::string orreryLabel(timepiece.getLabelAt(orreryIndex));
+				const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+				for (size_t index = 0; index < orreryTimepiece.getSize(); ++index)
+					newDictionary->labels.push_back(orreryLabel + std::string(orreryTimepiece.getLabelAt(index)));
+			}
+		}
+
+		dictionary = std::move(newDictionary);
+	}
+
+	if (!block) {
+		block = std::make_unique<Block>();
+		block->dictionary = dictionary;
+		block->firstTick = tick;
+		block->secondsOfDay.reserve(blockSamples * captured.getSize());
+	}
+
+	block->secondsOfDay.insert(block->secondsOfDay.end(), captured.secondsOfDay.begin(), captured.secondsOfDay.end());
+	block->lastTick = tick;
+	++block->sampleCount;
+	++sampleCount;
+
+	if (block->sampleCount == blockSamples) enqueueBlock();
+}
+
+void ColumnarLogWriter::enqueueBlock() {
+	if (!block) return;
+
+	blocks.push_back(std::move(block));
+	queued.notify_one();
+}
+
+void ColumnarLogWriter::writeBlocks() {
+	std::shared_ptr<const Dictionary> writtenDictionary;
+	std::unique_lock<std::mutex> lock(mtx);
+
+	while (true) {
+		queued.wait(lock, [this] { return isStopping || !blocks.empty(); });
+
+		if (blocks.empty()) return;
+
+		const std::unique_ptr<Block> nextBlock = std::move(blocks.front());
+
+		blocks.pop_front();
+		isWriting = true;
+		lock.unlock();
+		write(*nextBlock, writtenDictionary);
+		lock.lock();
+		isWriting = false;
+		++blockCount;
+		written.notify_all();
+	}
+}
+
+void ColumnarLogWriter::write(const Block& writtenBlock, std::shared_ptr<const Dictionary>& writtenDictionary) {
+	const Dictionary& blockDictionary = *writtenBlock.dictionary;
+	const size_t clockCount = blockDictionary.profileIds.size();
+
+	if (writtenBlock.dictionary != writtenDictionary) {
+		std::unordered_map<DayProfile::Id, size_t> profileIndices;
+		std::vector<DayProfile::Id> profiles;
+
+		for (const DayProfile::Id profileId : blockDictionary.profileIds) {
+			if (profileIndices.emplace(profileId, profiles.size()).second) profiles.push_back(profileId);
+		}
+
+		out.put(static_cast<char>(ColumnarLogRecord::Dictionary));
+		writeVarint(out, profiles.size());
+
+		for (const DayProfile::Id profileId : profiles) {
+			const DayProfile& profile = DayProfile::get(profileId);
+
+			writeSigned(out, profile.bodyMaxHours);
+			writeSigned(out, profile.bodyMaxMinutes);
+		}
+
+		writeVarint(out, clockCount);
+
+		for (size_t index = 0; index < clockCount; ++index) {
+			const std::string& label = blockDictionary.labels[index];
+
+			writeVarint(out, label.size());
+			out.write(label.data(), label.size());
+			writeVarint(out, profileIndices[blockDictionary.profileIds[index]]);
+		}
+
+		writtenDictionary = writtenBlock.dictionary;
+	}
+
+	out.put(static_cast<char>(ColumnarLogRecord::Block));
+	writeVarint(out, writtenBlock.firstTick);
+	writeVarint(out, interval);
+	writeVarint(out, writtenBlock.sampleCount);
+
+	// Each clock's column is its first value followed by runs of equal residuals
+	for (size_t index = 0; index < clockCount; ++index) {
+		const int daySeconds = DayProfile::get(blockDictionary.profileIds[index]).daySeconds;
+		int previous = writtenBlock.secondsOfDay[index];
+		std::uint64_t runLength = 0;
+		std::int64_t runResidual = 0;
+
+		writeVarint(out, static_cast<std::uint64_t>(previous));
+
+		for (size_t sample = 1; sample < writtenBlock.sampleCount; ++sample) {
+			const int value = writtenBlock.secondsOfDay[sample * clockCount + index];
+			const std::int64_t residual = getResidual(value, previous, interval, daySeconds);
+
+			if (runLength > 0 && residual != runResidual) {
+				writeVarint(out, runLength);
+				writeSigned(out, runResidual);
+				runLength = 0;
+			}
+
+			runResidual = residual;
+			++runLength;
+			previous = value;
+		}
+
+		if (runLength > 0) {
+			writeVarint(out, runLength);
+			writeSigned(out, runResidual);
+		}
+	}
+}
+
+ColumnarLogReader::ColumnarLogReader(std::istream& in) : in(in) {
+	char fileMagic[sizeof(ColumnarLogWriter::magic)] = {};
+
+	if (!in.read(fileMagic, sizeof(fileMagic)) ||
+		std::memcmp(fileMagic, ColumnarLogWriter::magic, sizeof(fileMagic)) != 0)
+		throw std::runtime_error("Not a columnar clock log");
+
+	if (in.get() != ColumnarLogWriter::version) throw std::runtime_error("Unsupported columnar log version");
+}
+
+bool ColumnarLogReader::next(ClockSnapshot& clockSnapshot) {
+	while (sampleIndex == sampleCount) {
+		if (!readRecord()) return false;
+	}
+
+	// The first sample is each clock's stored value, and every later one applies the clock's current run
+	if (sampleIndex > 0) {
+		for (size_t index = 0; index < labels.size(); ++index) {
+			RunCursor& cursor = runCursors[index];
+
+			if (cursor.remaining == 0) cursor.remaining = runs[cursor.runIndex].length;
+
+			secondsOfDay[index] = applyResidual(secondsOfDay[index], interval, runs[cursor.runIndex].residual,
+				daySeconds[index]);
+
+			if (--cursor.remaining == 0) ++cursor.runIndex;
+		}
+	}
+
+	clockSnapshot.tick = firstTick + sampleIndex * interval;
+	clockSnapshot.profileIds = profileIds;
+	clockSnapshot.secondsOfDay = secondsOfDay;
+	++sampleIndex;
+
+	return true;
+}
+
+std::uint64_t ColumnarLogReader::exportCsv(std::istream& in, std::ostream& out) {
+	ColumnarLogReader reader(in);
+	ClockSnapshot clockSnapshot;
+	std::vector<DayProfile::Id> clockProfileIds;
+	std::vector<CelestialDayClock> clocks;
+	std::uint64_t rowCount = 0;
+	char time[CelestialDayClock::maxTimeLength];
+
+	out << "tick,label,seconds_of_day,time\n";
+
+	while (reader.next(clockSnapshot)) {
+		if (clockSnapshot.profileIds != clockProfileIds) {
+			clocks.clear();
+			clocks.reserve(clockSnapshot.getSize());
+
+			for (const DayProfile::Id profileId : clockSnapshot.profileIds) {
+				const DayProfile& profile = DayProfile::get(profileId);
+
+				clocks.emplace_back(profile.bodyMaxHours, profile.bodyMaxMinutes);
+			}
+
+			clockProfileIds = clockSnapshot.profileIds;
+		}
+
+		for (size_t index = 0; index < clockSnapshot.getSize(); ++index) {
+			CelestialDayClock& clock = clocks[index];
+
+			clock.setSecondsOfDay(clockSnapshot.secondsOfDay[index]);
+			out << clockSnapshot.tick << ',';
+			writeCsvLabel(out, reader.getLabels()[index]);
+			out << ',' << clockSnapshot.secondsOfDay[index] << ',';
+			out.write(time, clock.formatTimeMilitary(time));
+			out.put('\n');
+			++rowCount;
+		}
+	}
+
+	if (!out) throw std::runtime_error("Failed to write CSV export");
+
+	return rowCount;
+}
+
+bool ColumnarLogReader::readRecord() {
+	const int record = in.get();
+
+	if (record == std::char_traits<char>::eof()) return false;
+
+	switch (static_cast<ColumnarLogRecord>(record)) {
+	case ColumnarLogRecord::Dictionary:
+		readDictionary();
+		break;
+	case ColumnarLogRecord::Block:
+		readBlock();
+		break;
+	default:
+		throw std::runtime_error("Unknown record in columnar log");
+	}
+
+	return true;
+}
+
+void ColumnarLogReader::readDictionary() {
+	std::vector<DayProfile::Id> profiles(readCount(in, DayProfile::maxCount, "profile count"));
+
+	for (DayProfile::Id& profileId : profiles) {
+		const std::int64_t bodyMaxHours = readSigned(in);
+		const std::int64_t bodyMaxMinutes = readSigned(in);
+
+		profileId = DayProfile::fromBodyMaximums(static_cast<int>(bodyMaxHours), static_cast<int>(bodyMaxMinutes));
+	}
+
+	const std::uint64_t clockCount = readVarint(in);
+
+	labels.clear();
+	profileIds.clear();
+	daySeconds.clear();
+
+	for (std::uint64_t index = 0; index < clockCount; ++index) {
+		std::string label;
+
+		readBytes(in, readVarint(in), label);
+
+		const std::uint64_t profileIndex = readVarint(in);
+
+		if (profileIndex >= profiles.size()) throw std::runtime_error("Corrupt profile index in columnar log");
+
+		labels.push_back(std::move(label));
+		profileIds.push_back(profiles[profileIndex]);
+		daySeconds.push_back(DayProfile::get(profiles[profileIndex]).daySeconds);
+	}
+
+	hasDictionary = true;
+}
+
+void ColumnarLogReader::readBlock() {
+	if (!hasDictionary) throw std::runtime_error("Columnar log block precedes its dictionary");
+
+	const size_t clockCount = labels.size();
+
+	firstTick = readVarint(in);
+	interval = readVarint(in);
+	sampleCount = readCount(in, ColumnarLogWriter::maxBlockSamples, "sample count");
+	sampleIndex = 0;
+
+	if (sampleCount == 0) throw std::runtime_error("Empty block in columnar log");
+
+	secondsOfDay.resize(clockCount);
+	runCursors.resize(clockCount);
+	runs.clear();
+
+	for (size_t index = 0; index < clockCount; ++index) {
+		const std::uint64_t first = readVarint(in);
+		std::uint64_t sample = 1;
+
+		if (first >= static_cast<std::uint64_t>(daySeconds[index]))
+			throw std::runtime_error("Corrupt seconds of day in columnar log");
+
+		secondsOfDay[index] = static_cast<int>(first);
+		runCursors[index] = { runs.size(), 0 };
+
+		while (sample < sampleCount) {
+			const std::uint64_t runLength = readVarint(in);
+			const std::int64_t residual = readSigned(in);
+
+			if (runLength == 0 || runLength > sampleCount - sample)
+				throw std::runtime_error("Corrupt run in columnar log");
+
+			runs.push_back({ runLength, residual });
+			sample += runLength;
+		}
+	}
+}
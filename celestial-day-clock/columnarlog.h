@@ -0,0 +1,137 @@
+#ifndef COLUMNAR_LOG_H
+#define COLUMNAR_LOG_H
+
+#include "clocksnapshot.h"
+#include "galactictimepiece.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ColumnarLogRecord : std::uint8_t {
+	Dictionary = 1,
+	Block
+};
+
+/* Appends a galactic timepiece's seconds of day to a columnar binary log every interval ticks. The
+   tick listener only copies seconds of day into the current block; a writer thread encodes full
+   blocks column by column, storing how far each clock strayed from advancing one second per tick
+   as run-length encoded varints. Labels and day profiles are written as a dictionary once, and
+   again only when clocks are added, removed or given new day lengths */
+class ColumnarLogWriter {
+public:
+	static constexpr char magic[4] = { 'C', 'D', 'C', 'L' };
+	static constexpr std::uint8_t version = 1;
+	static constexpr size_t defaultBlockSamples = 256;
+	static constexpr size_t maxBlockSamples = 64 * 1024;
+
+	ColumnarLogWriter(GalacticTimepiece& timepiece, std::ostream& out, std::uint64_t interval = 1,
+		size_t blockSamples = defaultBlockSamples);
+
+	~ColumnarLogWriter();
+
+	ColumnarLogWriter(const ColumnarLogWriter&) = delete;
+
+	ColumnarLogWriter& operator=(const ColumnarLogWriter&) = delete;
+
+	std::uint64_t getSampleCount() const;
+
+	std::uint64_t getBlockCount() const;
+
+	void flush();
+
+private:
+	struct Dictionary {
+		size_t revision = 0;
+		std::vector<DayProfile::Id> profileIds;
+		std::vector<std::string> labels;
+	};
+
+	struct Block {
+		std::shared_ptr<const Dictionary> dictionary;
+		std::uint64_t firstTick = 0;
+		std::uint64_t lastTick = 0;
+		size_t sampleCount = 0;
+		std::vector<int> secondsOfDay;
+	};
+
+	GalacticTimepiece& timepiece;
+	std::ostream& out;
+	std::uint64_t interval;
+	size_t blockSamples;
+	mutable std::mutex mtx;
+	std::condition_variable queued;
+	std::condition_variable written;
+	std::deque<std::unique_ptr<Block>> blocks;
+	std::unique_ptr<Block> block;
+	std::shared_ptr<const Dictionary> dictionary;
+	ClockSnapshot captured;
+	std::thread writerThread;
+	std::uint64_t sampleCount = 0;
+	std::uint64_t blockCount = 0;
+	size_t tickListenerId = 0;
+	bool isWriting = false;
+	bool isStopping = false;
+
+	void capture(std::uint64_t tick);
+
+	void enqueueBlock();
+
+	void writeBlocks();
+
+	void write(const Block& writtenBlock, std::shared_ptr<const Dictionary>& writtenDictionary);
+};
+
+/* Reads a columnar log one sampled tick at a time, and exports it to CSV with one row per clock
+   per sampled tick. Blocks are kept as the runs they were encoded as and expanded one sample at a
+   time, so memory grows with the bytes read rather than with the samples a block claims */
+class ColumnarLogReader {
+public:
+	explicit ColumnarLogReader(std::istream& in);
+
+	bool next(ClockSnapshot& clockSnapshot);
+
+	const std::vector<std::string>& getLabels() const { return labels; }
+
+	static std::uint64_t exportCsv(std::istream& in, std::ostream& out);
+
+private:
+	struct Run {
+		std::uint64_t length;
+		std::int64_t residual;
+	};
+
+	// Where a clock is in its runs, which are stored in clock order
+	struct RunCursor {
+		size_t runIndex;
+		std::uint64_t remaining;
+	};
+
+	std::istream& in;
+	std::vector<std::string> labels;
+	std::vector<DayProfile::Id> profileIds;
+	std::vector<int> daySeconds;
+	std::vector<int> secondsOfDay;
+	std::vector<Run> runs;
+	std::vector<RunCursor> runCursors;
+	std::uint64_t firstTick = 0;
+	std::uint64_t interval = 0;
+	size_t sampleCount = 0;
+	size_t sampleIndex = 0;
+	bool hasDictionary = false;
+
+	bool readRecord();
+
+	void readDictionary();
+
+	void readBlock();
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "dayphase.h"
+#include <stdexcept>
+
+// The end of the run of clocks from first on that clock's day profile
+static size_t getProfileRunEnd(const ClockSnapshot& clockSnapshot, size_t first) {
+	const DayProfile::Id* const profileIds = clockSnapshot.profileIds.data();
+	const size_t size = clockSnapshot.getSize();
+	size_t last = first + 1;
+
+	while (last < size && profileIds[last] == profileIds[first]) ++last;
+
+	return last;
+}
+
+/* Each run of clocks on one profile is converted by a loop whose day length and phase step are
+   loop invariant, so runs vectorize instead of gathering constants per clock */
+static void fromSecondsOfDayRun(const int* secondsOfDay, size_t size, const DayProfile& profile,
+	std::uint32_t* phases) {
+	const std::uint64_t daySeconds = profile.daySeconds;
+	const std::uint64_t phaseStep = profile.phaseStep;
+
+	for (size_t index = 0; index < size; ++index)
+		phases[index] = DayPhase::fromSecondsOfDay(secondsOfDay[index], daySeconds, phaseStep);
+}
+
+static void toSecondsOfDayRun(const std::uint32_t* phases, size_t size, const DayProfile& profile,
+	int* secondsOfDay) {
+	const std::uint64_t daySeconds = profile.daySeconds;
+
+	for (size_t index = 0; index < size; ++index)
+		secondsOfDay[index] = DayPhase::toSecondsOfDay(phases[index], daySeconds);
+}
+
+void DayPhase::fromSnapshot(const ClockSnapshot& clockSnapshot, std::vector<std::uint32_t>& phases) {
+	const size_t size = clockSnapshot.getSize();
+
+	phases.resize(size);
+
+	for (size_t first = 0; first < size;) {
+		const size_t last = getProfileRunEnd(clockSnapshot, first);
+
+		fromSecondsOfDayRun(clockSnapshot.secondsOfDay.data() + first, last - first,
+			DayProfile::get(clockSnapshot.profileIds[first]), phases.data() + first);
+		first = last;
+	}
+}
+
+void DayPhase::toSnapshot(const std::vector<std::uint32_t>& phases, ClockSnapshot& clockSnapshot) {
+	const size_t size = clockSnapshot.getSize();
+
+	if (phases.size() != size) throw std::invalid_argument("Phase count does not match clock count");
+
+	for (size_t first = 0; first < size;) {
+		const size_t last = getProfileRunEnd(clockSnapshot, first);
+
+		toSecondsOfDayRun(phases.data() + first, last - first,
+			DayProfile::get(clockSnapshot.profileIds[first]), clockSnapshot.secondsOfDay.data() + first);
+		first = last;
+	}
+}
+
+void DayPhase::rescale(std::vector<int>& secondsOfDay, const DayProfile& from, const DayProfile& to) {
+	const std::uint64_t fromDaySeconds = from.daySeconds;
+	const std::uint64_t fromPhaseStep = from.phaseStep;
+	const std::uint64_t toDaySeconds = to.daySeconds;
+	const size_t size = secondsOfDay.size();
+	int* const times = secondsOfDay.data();
+
+	for (size_t index = 0; index < size; ++index)
+		times[index] = toSecondsOfDay(fromSecondsOfDay(times[index], fromDaySeconds, fromPhaseStep), toDaySeconds);
+}
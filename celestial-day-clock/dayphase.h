@@ -0,0 +1,57 @@
+#ifndef DAY_PHASE_H
+#define DAY_PHASE_H
+
+#include "clocksnapshot.h"
+#include "dayprofile.h"
+#include <cstdint>
+#include <vector>
+
+/* Conversions between seconds of day and day phase, a Q0.32 fixed-point fraction of a full day that
+   lets clocks on bodies with different day lengths be compared and aligned directly */
+class DayPhase {
+public:
+	static constexpr std::uint64_t one = std::uint64_t(1) << 32;
+
+	/* Exact floor(secondsOfDay * 2^32 / daySeconds) from the halves of the phase step and one
+	   correction. Day lengths fit in 31 bits and phases in 32, so every product is at most 32 by 32
+	   bits and the remainder wraps exactly in 32 bits, which keeps loops vectorizable on SSE2 */
+	static std::uint32_t fromSecondsOfDay(int secondsOfDay, std::uint64_t daySeconds,
+		std::uint64_t phaseStep) {
+		const std::uint32_t seconds = static_cast<std::uint32_t>(secondsOfDay);
+		const std::uint32_t day = static_cast<std::uint32_t>(daySeconds);
+		const std::uint32_t stepHigh = static_cast<std::uint32_t>(phaseStep >> 32);
+		const std::uint32_t stepLow = static_cast<std::uint32_t>(phaseStep);
+		std::uint32_t phase = seconds * stepHigh +
+			static_cast<std::uint32_t>((static_cast<std::uint64_t>(seconds) * stepLow) >> 32);
+
+		phase += static_cast<std::uint32_t>(0u - phase * day) >= day;
+
+		return phase;
+	}
+
+	// The first second of day at or after the phase, so converting a phase back is exact
+	static int toSecondsOfDay(std::uint32_t phase, std::uint64_t daySeconds) {
+		const std::uint32_t day = static_cast<std::uint32_t>(daySeconds);
+		const std::uint32_t secondsOfDay =
+			static_cast<std::uint32_t>((static_cast<std::uint64_t>(phase) * day + one - 1) >> 32);
+
+		return static_cast<int>(secondsOfDay - (secondsOfDay >= day ? day : 0));
+	}
+
+	static std::uint32_t fromSecondsOfDay(int secondsOfDay, const DayProfile& profile) {
+		return fromSecondsOfDay(secondsOfDay, profile.daySeconds, profile.phaseStep);
+	}
+
+	static int toSecondsOfDay(std::uint32_t phase, const DayProfile& profile) {
+		return toSecondsOfDay(phase, profile.daySeconds);
+	}
+
+	static void fromSnapshot(const ClockSnapshot& clockSnapshot, std::vector<std::uint32_t>& phases);
+
+	static void toSnapshot(const std::vector<std::uint32_t>& phases, ClockSnapshot& clockSnapshot);
+
+	// Moves times of day from one day length to another at the same phase in one branch-free pass
+	static void rescale(std::vector<int>& secondsOfDay, const DayProfile& from, const DayProfile& to);
+};
+
+#endif
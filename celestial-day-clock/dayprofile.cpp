@@ -0,0 +1,160 @@
+#include "dayprofile.h"
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static constexpr size_t profileChunkSize = 256;
+
+// Profiles live in fixed-capacity chunks so published references stay valid while interning
+struct DayProfileRegistry {
+	std::mutex mtx;
+	std::map<std::pair<int, int>, DayProfile::Id> ids;
+	std::array<std::unique_ptr<std::vector<DayProfile>>, DayProfile::maxCount / profileChunkSize> chunks;
+	std::atomic<size_t> count = 0;
+};
+
+static DayProfileRegistry& getRegistry() {
+	static DayProfileRegistry registry;
+
+	return registry;
+}
+
+static int countDigits(int value) {
+	int digits = 1;
+
+	while (value >= 10) {
+		value /= 10;
+		++digits;
+	}
+
+	return digits;
+}
+
+static int getBodyMaxHours(int maxHours, int maxMinutes) {
+	const bool hasTrulyOddMaxHours = maxHours % 2 == 1 &&
+		maxMinutes >= DayProfile::minutesPerHour / 2;
+
+	if (hasTrulyOddMaxHours || maxMinutes == 0) return maxHours;
+
+	return maxHours - 1;
+}
+
+static int getBodyMaxMinutes(int maxHours, int maxMinutes) {
+	if (getBodyMaxHours(maxHours, maxMinutes) % 2 == 1)
+		return (maxMinutes - DayProfile::minutesPerHour / 2) * 2;
+
+	return maxMinutes * 2;
+}
+
+static int getHalfDaySeconds(int maxHours, int maxMinutes) {
+	if (maxMinutes == 0) return maxHours / 2 * DayProfile::secondsPerHour;
+
+	return maxHours / 2 * DayProfile::secondsPerHour + maxMinutes * DayProfile::secondsPerMinute;
+}
+
+// floor(2^64 / daySeconds), the day length's reciprocal for fixed-point phase computation
+static std::uint64_t getPhaseStep(int daySeconds) {
+	const std::uint64_t divisor = static_cast<std::uint64_t>(daySeconds);
+	const bool isPowerOfTwo = (divisor & (divisor - 1)) == 0;
+
+	return UINT64_MAX / divisor + (isPowerOfTwo ? 1 : 0);
+}
+
+DayProfile::DayProfile(int normalizedMaxHours, int normalizedMaxMinutes) :
+	maxHours(normalizedMaxHours),
+	maxMinutes(normalizedMaxMinutes),
+	halfHours(normalizedMaxHours / 2),
+	hoursResetThreshold(normalizedMaxHours - 1),
+	minutesResetThreshold(normalizedMaxMinutes - 1),
+	bodyMaxHours(getBodyMaxHours(normalizedMaxHours, normalizedMaxMinutes)),
+	bodyMaxMinutes(getBodyMaxMinutes(normalizedMaxHours, normalizedMaxMinutes)),
+	halfDaySeconds(getHalfDaySeconds(normalizedMaxHours, normalizedMaxMinutes)),
+	daySeconds(getHalfDaySeconds(normalizedMaxHours, normalizedMaxMinutes) * 2),
+	militaryHoursWidth(countDigits(normalizedMaxHours)),
+	standardHoursWidth(countDigits(normalizedMaxHours / 2)),
+	militaryTimeWidth(countDigits(normalizedMaxHours) + 6),
+	standardTimeWidth(countDigits(normalizedMaxHours / 2) + 9),
+	phaseStep(getPhaseStep(getHalfDaySeconds(normalizedMaxHours, normalizedMaxMinutes) * 2)) {
+}
+
+int DayProfile::toSecondsOfDay(int hours, int minutes, int seconds) const {
+	const int hourSeconds = minutes * secondsPerMinute + seconds;
+	int secondsOfDay = hours * secondsPerHour + hourSeconds;
+
+	if (maxMinutes != 0 && hours > halfHours)
+		secondsOfDay = halfDaySeconds + (hours - halfHours - 1) * secondsPerHour + hourSeconds;
+
+	return secondsOfDay;
+}
+
+DayProfile::Id DayProfile::fromBodyMaximums(int h, int m) {
+	constexpr int maxHoursMin = 2;
+	constexpr int radixMax = radix - 1;
+	constexpr int secondaryRadixMax = secondaryRadix - 1;
+	constexpr int halfMaxBodyMinutes = (radixMax / 2 * secondaryRadix + secondaryRadixMax) - 1;
+
+	if (h < maxHoursMin) h = maxHoursMin;
+
+	m = m / 2;
+
+	if (m < 0) m = 0;
+
+	if (m % 2 == 1) --m;
+
+	if (m > halfMaxBodyMinutes) m = halfMaxBodyMinutes;
+
+	if (h % 2 == 1) {
+		--h;
+		m += minutesPerHour / 2;
+	}
+
+	if (m > 0) ++h;
+
+	return intern(h, m);
+}
+
+DayProfile::Id DayProfile::intern(int normalizedMaxHours, int normalizedMaxMinutes) {
+	DayProfileRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mtx);
+	const auto key = std::make_pair(normalizedMaxHours, normalizedMaxMinutes);
+	const auto itr = registry.ids.find(key);
+
+	if (itr != registry.ids.end()) return itr->second;
+
+	const size_t count = registry.count.load(std::memory_order_relaxed);
+
+	if (count >= maxCount) throw std::length_error("Day profile capacity exceeded");
+
+	std::unique_ptr<std::vector<DayProfile>>& chunk = registry.chunks[count / profileChunkSize];
+
+	if (!chunk) {
+		chunk = std::make_unique<std::vector<DayProfile>>();
+		chunk->reserve(profileChunkSize);
+	}
+
+	chunk->emplace_back(normalizedMaxHours, normalizedMaxMinutes);
+
+	const Id id = static_cast<Id>(count);
+
+	registry.ids.emplace(key, id);
+	registry.count.store(count + 1, std::memory_order_release);
+
+	return id;
+}
+
+const DayProfile& DayProfile::get(Id id) {
+	const DayProfileRegistry& registry = getRegistry();
+
+	if (id >= registry.count.load(std::memory_order_acquire))
+		throw std::out_of_range("Day profile " + std::to_string(id) + " not found");
+
+	return (*registry.chunks[id / profileChunkSize])[id % profileChunkSize];
+}
+
+size_t DayProfile::getCount() { return getRegistry().count.load(std::memory_order_acquire); }
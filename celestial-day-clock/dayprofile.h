@@ -0,0 +1,49 @@
+#ifndef DAY_PROFILE_H
+#define DAY_PROFILE_H
+
+#include "numeric_limits.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+/* An immutable description of a celestial day's shape that is interned once and shared by every
+   clock with the same normalized maximums */
+struct DayProfile {
+	using Id = std::uint16_t;
+
+	static constexpr int radix = numeric_limits<std::time_t>::radices[0];
+	static constexpr int secondaryRadix = numeric_limits<std::time_t>::radices[1];
+	static constexpr int minutesPerHour = radix * secondaryRadix;
+	static constexpr int secondsPerMinute = radix * secondaryRadix;
+	static constexpr int secondsPerHour = minutesPerHour * secondsPerMinute;
+	static constexpr size_t maxCount = static_cast<size_t>(UINT16_MAX) + 1;
+
+	const int maxHours;
+	const int maxMinutes;
+	const int halfHours;
+	const int hoursResetThreshold;
+	const int minutesResetThreshold;
+	const int bodyMaxHours;
+	const int bodyMaxMinutes;
+	const int halfDaySeconds;
+	const int daySeconds;
+	const int militaryHoursWidth;
+	const int standardHoursWidth;
+	const int militaryTimeWidth;
+	const int standardTimeWidth;
+	const std::uint64_t phaseStep;
+
+	DayProfile(int normalizedMaxHours, int normalizedMaxMinutes);
+
+	int toSecondsOfDay(int hours, int minutes, int seconds) const;
+
+	static Id fromBodyMaximums(int h, int m);
+
+	static Id intern(int normalizedMaxHours, int normalizedMaxMinutes);
+
+	static const DayProfile& get(Id id);
+
+	static size_t getCount();
+};
+
+#endif
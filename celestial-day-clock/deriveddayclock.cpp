@@ -0,0 +1,7 @@
+#include "deriveddayclock.h"
+
+std::vector<std::string> DerivedDayClock::getTimes() {
+	sync();
+
+	return CelestialDayClock::getTimes();
+}
@@ -0,0 +1,34 @@
+#ifndef DERIVED_DAY_CLOCK_H
+#define DERIVED_DAY_CLOCK_H
+
+#include "celestialdayclock.h"
+#include <string>
+#include <vector>
+
+/* A clock whose time is derived from another source whenever it is synced instead of being ticked.
+   Orreries keep derived clocks apart from the clocks they tick and sync them before every read, so
+   setting a derived clock's time directly lasts only until its next sync */
+class DerivedDayClock : public CelestialDayClock {
+public:
+	using CelestialDayClock::CelestialDayClock;
+
+	virtual void sync() = 0;
+
+	// The clock this one derives its time from, which an orrery holding this clock must also hold
+	virtual const CelestialDayClock* getSource() const { return nullptr; }
+
+	// Whether the clock advances one second whenever the clocks of its orrery tick
+	virtual bool isTickDriven() const { return false; }
+
+	// Moves the clock to another day profile at its current phase, rescaling whatever its time derives from
+	virtual void reprofile(DayProfile::Id toProfileId) = 0;
+
+	std::vector<std::string> getTimes() override;
+
+	// Derived clocks are synced when read, so they take no part in a tick plan
+	void compileTickPlan(TickPlan&) override {}
+
+	void tick() override { sync(); }
+};
+
+#endif
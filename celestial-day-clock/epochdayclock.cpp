@@ -0,0 +1,46 @@
+#include "epochdayclock.h"
+#include "dayphase.h"
+
+EpochDayClock::EpochDayClock(int h, int m, std::time_t epoch, int epochSecondsOfDay) : DerivedDayClock(h, m) {
+	setAnchor(epoch, epochSecondsOfDay);
+	sync();
+}
+
+EpochDayClock::EpochDayClock(const CelestialDayClock& clock, std::time_t now)
+	: DerivedDayClock(clock.getProfile().bodyMaxHours, clock.getProfile().bodyMaxMinutes) {
+	setAnchor(now, clock.getSecondsOfDay());
+	syncAt(now);
+}
+
+void EpochDayClock::sync() { syncAt(std::time(nullptr)); }
+
+// Anchors and wall times are kept within one day of each other before narrowing to int
+void EpochDayClock::syncAt(std::time_t now) {
+	const std::time_t daySeconds = getProfile().daySeconds;
+
+	syncSecondsOfDay(static_cast<int>(((now - anchor) % daySeconds + daySeconds) % daySeconds));
+}
+
+void EpochDayClock::reprofile(DayProfile::Id toProfileId) { reprofileAt(toProfileId, std::time(nullptr)); }
+
+void EpochDayClock::reprofileAt(DayProfile::Id toProfileId, std::time_t now) {
+	const DayProfile& toProfile = DayProfile::get(toProfileId);
+
+	syncAt(now);
+	setProfile(toProfileId, DayPhase::toSecondsOfDay(getDayPhase(), toProfile));
+	setAnchor(now, getSecondsOfDay());
+}
+
+MemoryUsage EpochDayClock::memoryUsage() const {
+	MemoryUsage usage;
+
+	usage.stateBytes = sizeof(EpochDayClock);
+
+	return usage;
+}
+
+void EpochDayClock::setAnchor(std::time_t epoch, int epochSecondsOfDay) {
+	const std::time_t daySeconds = getProfile().daySeconds;
+
+	anchor = epoch - ((epochSecondsOfDay % daySeconds + daySeconds) % daySeconds);
+}
@@ -0,0 +1,35 @@
+#ifndef EPOCH_DAY_CLOCK_H
+#define EPOCH_DAY_CLOCK_H
+
+#include "deriveddayclock.h"
+#include <ctime>
+
+/* A clock whose time of day is a pure function of the wall clock: it stores the wall time at which
+   one of its days began and computes its time from std::time whenever it is synced. Orreries and
+   galaxies made of epoch clocks have nothing to tick, and a read costs a few integer divisions */
+class EpochDayClock : public DerivedDayClock {
+public:
+	EpochDayClock(int h, int m, std::time_t epoch = 0, int epochSecondsOfDay = 0);
+
+	EpochDayClock(const CelestialDayClock& clock, std::time_t now);
+
+	std::time_t getAnchor() const { return anchor; }
+
+	void sync() override;
+
+	void syncAt(std::time_t now);
+
+	void reprofile(DayProfile::Id toProfileId) override;
+
+	// Re-anchors the clock so that at the given wall time it shows the same phase on the new day
+	void reprofileAt(DayProfile::Id toProfileId, std::time_t now);
+
+	MemoryUsage memoryUsage() const override;
+
+private:
+	std::time_t anchor = 0;
+
+	void setAnchor(std::time_t epoch, int epochSecondsOfDay);
+};
+
+#endif
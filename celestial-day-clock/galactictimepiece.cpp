@@ -1,5 +1,9 @@
 #include "galactictimepiece.h"
+#include "dayphase.h"
+#include "tracer.h"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <thread>
 
@@ -11,7 +15,7 @@ GalacticTimepiece::~GalacticTimepiece() {
 size_t GalacticTimepiece::getSize() const {
 	size_t size = 0;
 
-	for (const std::pair<std::string, OrreryTimepiece*>& timepiece : timepieces) {
+	for (const std::pair<LabelPool::Id, OrreryTimepiece*>& timepiece : timepieces) {
 		if (timepiece.second == nullptr)
 			throw std::runtime_error("Null timepiece pointer encountered in getSize");
 
@@ -21,31 +25,113 @@ size_t GalacticTimepiece::getSize() const {
 	return size;
 }
 
-void GalacticTimepiece::add(const std::string& label, OrreryTimepiece* timepiece) {
+// A sum of revisions could stay the same when an orrery is removed, but the newest one always increases
+size_t GalacticTimepiece::getRevision() const {
+	size_t newestRevision = revision;
+
+	for (const std::pair<LabelPool::Id, OrreryTimepiece*>& timepiece : timepieces) {
+		if (timepiece.second == nullptr)
+			throw std::runtime_error("Null timepiece pointer encountered in getRevision");
+
+		newestRevision = std::max(newestRevision, timepiece.second->getRevision());
+	}
+
+	return newestRevision;
+}
+
+MemoryUsage GalacticTimepiece::memoryUsage() const {
+	MemoryUsage usage;
+
+	usage.stateBytes = sizeof(GalacticTimepiece);
+	usage.addVector(timepieces);
+	usage.addVector(tickListeners);
+
+	for (const std::pair<LabelPool::Id, OrreryTimepiece*>& timepiece : timepieces) {
+		if (timepiece.second == nullptr)
+			throw std::runtime_error("Null timepiece pointer encountered in memoryUsage");
+
+		usage += timepiece.second->memoryUsage();
+		usage.labelBytes += LabelPool::get(timepiece.first).size();
+		usage.addAllocation(sizeof(OrreryTimepiece), alignof(OrreryTimepiece));
+	}
+
+	usage.addVector(renderCaches);
+
+	for (const std::unique_ptr<RenderCache>& cache : renderCaches) {
+		usage += cache->memoryUsage();
+		usage.addAllocation(sizeof(RenderCache));
+	}
+
+	return usage;
+}
+
+void GalacticTimepiece::compileTickPlan(TickPlan& plan) {
+	for (const std::pair<LabelPool::Id, OrreryTimepiece*>& timepiece : timepieces) {
+		if (timepiece.second == nullptr)
+			throw std::runtime_error("Null timepiece pointer encountered in compileTickPlan");
+
+		timepiece.second->compileTickPlan(plan);
+	}
+}
+
+bool GalacticTimepiece::add(const std::string& label, OrreryTimepiece* timepiece) {
 	if (timepiece == nullptr) throw std::invalid_argument("Cannot add a null timepiece");
 
+	const LabelPool::Id labelId = LabelPool::intern(label);
+
 	for (const auto& [existingLabel, existingTimepiece] : timepieces) {
 		if (existingTimepiece == nullptr)
 			throw std::runtime_error("Null timepiece pointer encountered in add");
 
-		if (label == existingLabel) {
+		if (labelId == existingLabel) {
 			std::cerr << "Timepiece with label " << label << " already exists" << std::endl;
-			return;
+			return false;
 		}
 	}
 
 	stopTicking();
-	timepieces.emplace_back(label, timepiece);
+	timepieces.emplace_back(labelId, timepiece);
+	revision = nextRevision();
+	tickPlan.invalidate();
+
+	return true;
 }
 
 OrreryTimepiece& GalacticTimepiece::getTimepiece(const std::string& searchLabel) {
+	LabelPool::Id searchId = 0;
+	const bool isInterned = LabelPool::find(searchLabel, searchId);
+
 	stopTicking();
 
 	for (const auto& [label, timepiece] : timepieces) {
 		if (timepiece == nullptr)
 			throw std::runtime_error("Null timepiece pointer encountered in getTimepiece");
 
-		if (searchLabel == label) return *timepiece;
+		if (isInterned && searchId == label) return *timepiece;
+	}
+
+	throw std::runtime_error("Timepiece with label " + searchLabel + " not found");
+}
+
+OrreryTimepiece* GalacticTimepiece::remove(const std::string& searchLabel) {
+	LabelPool::Id searchId = 0;
+	const bool isInterned = LabelPool::find(searchLabel, searchId);
+
+	stopTicking();
+
+	for (auto entry = timepieces.begin(); entry != timepieces.end(); ++entry) {
+		if (entry->second == nullptr)
+			throw std::runtime_error("Null timepiece pointer encountered in remove");
+
+		if (isInterned && searchId == entry->first) {
+			OrreryTimepiece* const timepiece = entry->second;
+
+			timepieces.erase(entry);
+			revision = nextRevision();
+			tickPlan.invalidate();
+
+			return timepiece;
+		}
 	}
 
 	throw std::runtime_error("Timepiece with label " + searchLabel + " not found");
@@ -55,6 +141,49 @@ void GalacticTimepiece::clear() {
 	stopTicking();
 	deleteTimepieces();
 	timepieces.clear();
+	revision = nextRevision();
+	tickPlan.invalidate();
+}
+
+void GalacticTimepiece::snapshot(ClockSnapshot& clockSnapshot) {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	takeSnapshot(clockSnapshot);
+}
+
+void GalacticTimepiece::getDayPhases(std::vector<std::uint32_t>& phases) {
+	ClockSnapshot clockSnapshot;
+
+	snapshot(clockSnapshot);
+	DayPhase::fromSnapshot(clockSnapshot, phases);
+}
+
+void GalacticTimepiece::setDayPhases(const std::vector<std::uint32_t>& phases) {
+	std::lock_guard<std::mutex> lock(mtx);
+	ClockSnapshot clockSnapshot;
+	size_t clockIndex = 0;
+
+	takeSnapshot(clockSnapshot);
+	DayPhase::toSnapshot(phases, clockSnapshot);
+
+	for (const auto& [label, timepiece] : timepieces) {
+		for (size_t index = 0; index < timepiece->getSize(); ++index)
+			timepiece->getClockAt(index).setSecondsOfDay(clockSnapshot.secondsOfDay[clockIndex++]);
+	}
+}
+
+size_t GalacticTimepiece::reprofile(DayProfile::Id fromProfileId, DayProfile::Id toProfileId) {
+	std::lock_guard<std::mutex> lock(mtx);
+	size_t clockCount = 0;
+
+	for (const auto& [label, timepiece] : timepieces) {
+		if (timepiece == nullptr)
+			throw std::runtime_error("Null timepiece pointer encountered in reprofile");
+
+		clockCount += timepiece->reprofile(fromProfileId, toProfileId);
+	}
+
+	return clockCount;
 }
 
 std::vector<std::string> GalacticTimepiece::getTimesMilitary() {
@@ -62,12 +191,15 @@ std::vector<std::string> GalacticTimepiece::getTimesMilitary() {
 
 	stopTicking();
 
+	std::lock_guard<std::mutex> lock(mtx);
+	RenderCache& cache = getTimesCache();
+
 	for (const auto& [label, timepiece] : timepieces) {
 		if (timepiece == nullptr)
 			throw std::runtime_error("Null timepiece pointer encountered in getTimesMilitary");
 
-		for (const std::string& time : timepiece->getTimesMilitary()) {
-			times.emplace_back(label + time);
+		for (const std::string& time : timepiece->getTimesMilitary(cache)) {
+			times.emplace_back(LabelPool::prefix(label, time));
 		}
 	}
 
@@ -79,48 +211,124 @@ std::vector<std::string> GalacticTimepiece::getTimes() {
 
 	stopTicking();
 
+	std::lock_guard<std::mutex> lock(mtx);
+	RenderCache& cache = getTimesCache();
+
 	for (const auto& [label, timepiece] : timepieces) {
 		if (timepiece == nullptr)
 			throw std::runtime_error("Null timepiece pointer encountered in getTimes");
 
-		for (const std::string& time : timepiece->getTimes()) {
-			times.emplace_back(label + time);
+		for (const std::string& time : timepiece->getTimes(cache)) {
+			times.emplace_back(LabelPool::prefix(label, time));
 		}
 	}
 
 	return times;
 }
 
+// getTimes and getTimesMilitary share the first render worker's cache, which outlives the call
+RenderCache& GalacticTimepiece::getTimesCache() {
+	if (renderCaches.empty()) renderCaches.push_back(std::make_unique<RenderCache>());
+
+	return *renderCaches.front();
+}
+
+void GalacticTimepiece::renderTimesMilitary(RenderedTimes& times) { render(times, true); }
+
+void GalacticTimepiece::setRenderCaching(bool isEnabled) {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	isRenderCaching = isEnabled;
+}
+
+std::uint64_t GalacticTimepiece::getRenderCacheHitCount() {
+	std::lock_guard<std::mutex> lock(mtx);
+	std::uint64_t hitCount = 0;
+
+	for (const std::unique_ptr<RenderCache>& cache : renderCaches) hitCount += cache->getHitCount();
+
+	return hitCount;
+}
+
+std::uint64_t GalacticTimepiece::getRenderCacheMissCount() {
+	std::lock_guard<std::mutex> lock(mtx);
+	std::uint64_t missCount = 0;
+
+	for (const std::unique_ptr<RenderCache>& cache : renderCaches) missCount += cache->getMissCount();
+
+	return missCount;
+}
+
+void GalacticTimepiece::renderTimes(RenderedTimes& times) { render(times, false); }
+
 void GalacticTimepiece::tick() {
+	CDC_TRACE_SCOPE("GalacticTimepiece::tick");
 	std::lock_guard<std::mutex> lock(mtx);
-	const std::vector<std::pair<std::string, OrreryTimepiece*>>::iterator mid =
-		timepieces.begin() + timepieces.size() / 2;
 
-	const auto tickRng = [](auto start, const auto end) {
-		try {
-			for (auto& itr = start; itr != end; ++itr) {
-				if (itr->second == nullptr) throw std::runtime_error("Null timepiece pointer encountered in tick");
+	const auto tickRng = [this](size_t begin, size_t end) {
+		CDC_TRACE_SCOPE("GalacticTimepiece::tick half");
 
-				itr->second->tick();
-			}
-		}
-		catch (const std::exception& e) {
-			std::cerr << "Exception in tickRange: " << e.what() << std::endl;
-			throw;
-		}
+		tickPlan.tick(begin, end);
 		};
 
-	std::future<void> firstHalf = std::async(std::launch::async, tickRng, timepieces.begin(), mid);
-	std::future<void> secondHalf = std::async(std::launch::async, tickRng, mid, timepieces.end());
-
 	try {
-		firstHalf.get();
-		secondHalf.get();
+		if (!tickPlan.isCurrent(*this)) tickPlan.compile(*this);
+
+		if (tickThreadCount <= 1) {
+			tickRng(0, tickPlan.getSize());
+		}
+		else {
+			const size_t split = tickPlan.getSplit();
+			std::future<void> firstHalf;
+			std::future<void> secondHalf;
+
+			{
+				CDC_TRACE_SCOPE("GalacticTimepiece::tick dispatch");
+
+				firstHalf = std::async(std::launch::async, tickRng, 0, split);
+				secondHalf = std::async(std::launch::async, tickRng, split, tickPlan.getSize());
+			}
+
+			CDC_TRACE_SCOPE("GalacticTimepiece::tick join");
+
+			firstHalf.get();
+			secondHalf.get();
+		}
+
+		tickPlan.tickCounters();
 	}
 	catch (const std::exception& e) {
+		tickPlan.invalidate();
 		std::cerr << "Exception in tick: " << e.what() << std::endl;
 		stopTicking();
+
+		return;
 	}
+
+	const std::uint64_t currentTick = ++tickCount;
+
+	CDC_TRACE_SCOPE("GalacticTimepiece::tick listeners");
+
+	for (const auto& [listenerId, listener] : tickListeners) listener(currentTick);
+}
+
+void GalacticTimepiece::setTimeSource(TimeSource* source) {
+	stopTicking();
+	timeSource = source == nullptr ? &SteadyTimeSource::getInstance() : source;
+}
+
+size_t GalacticTimepiece::addTickListener(std::function<void(std::uint64_t)> listener) {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	tickListeners.emplace_back(nextListenerId, std::move(listener));
+
+	return nextListenerId++;
+}
+
+void GalacticTimepiece::removeTickListener(size_t listenerId) {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	std::erase_if(tickListeners, [listenerId](const auto& entry) { return entry.first == listenerId; });
 }
 
 void GalacticTimepiece::startTicking() {
@@ -131,19 +339,19 @@ void GalacticTimepiece::startTicking() {
 	auto runTicks = [this]() {
 		constexpr auto oneSecondInNanoseconds =
 			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds(1)).count();
-		auto nextTick = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+		auto nextTick = timeSource->now() + std::chrono::seconds(1);
 
 		try {
 			while (running) {
-				const auto start = std::chrono::steady_clock::now();
+				const auto start = timeSource->now();
 				tick();
-				const auto end = std::chrono::steady_clock::now();
+				const auto end = timeSource->now();
 				const auto tickDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 
 				if (tickDuration > oneSecondInNanoseconds)
 					std::cerr << "Tick duration exceeded " << oneSecondInNanoseconds << " nanoseconds" << std::endl;
 
-				std::this_thread::sleep_until(nextTick);
+				timeSource->sleepUntil(nextTick);
 				nextTick += std::chrono::seconds(1);
 			}
 		}
@@ -162,8 +370,143 @@ void GalacticTimepiece::stopTicking() {
 	if (tickingFuture.valid()) tickingFuture.get();
 }
 
+void GalacticTimepiece::simulate(std::uint64_t ticks) {
+	stopTicking();
+
+	TimeSource::TimePoint nextTick = timeSource->now();
+
+	for (std::uint64_t simulatedTick = 0; simulatedTick < ticks; ++simulatedTick) {
+		tick();
+		nextTick += std::chrono::seconds(1);
+		timeSource->sleepUntil(nextTick);
+	}
+}
+
+void GalacticTimepiece::takeSnapshot(ClockSnapshot& clockSnapshot) const {
+	clockSnapshot.tick = tickCount;
+	clockSnapshot.profileIds.clear();
+	clockSnapshot.secondsOfDay.clear();
+
+	for (const auto& [label, timepiece] : timepieces) {
+		if (timepiece == nullptr)
+			throw std::runtime_error("Null timepiece pointer encountered in snapshot");
+
+		timepiece->syncViews();
+
+		for (size_t index = 0; index < timepiece->getSize(); ++index) {
+			const CelestialDayClock& clock = timepiece->getClockAt(index);
+
+			clockSnapshot.profileIds.push_back(clock.getProfileId());
+			clockSnapshot.secondsOfDay.push_back(clock.getSecondsOfDay());
+		}
+	}
+}
+
+void GalacticTimepiece::render(RenderedTimes& times, bool isMilitary) {
+	constexpr size_t minParallelRenderLines = 4096;
+	std::lock_guard<std::mutex> lock(mtx);
+
+	// Derived clocks are only synced when read, and render workers read clocks without syncing them
+	for (const auto& [label, timepiece] : timepieces) timepiece->syncViews();
+
+	layoutRender(times, isMilitary);
+
+	const size_t lineCount = times.lines.size();
+	const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	const size_t workerCount = lineCount < minParallelRenderLines ? 1 :
+		std::min(hardwareThreads, timepieces.size());
+
+	const auto renderRng = [this, &times, isMilitary](size_t first, const size_t last, RenderCache* cache) {
+		for (; first != last; ++first) {
+			const std::string_view label = LabelPool::get(timepieces[first].first);
+			const OrreryTimepiece& timepiece = *timepieces[first].second;
+			size_t line = times.orreryLines[first];
+
+			for (size_t index = 0; index < timepiece.getSize(); ++index, ++line) {
+				const std::string_view clockLabel = timepiece.getLabelAt(index);
+				const CelestialDayClock& clock = timepiece.getClockAt(index);
+				char* const start = times.buffer.data() + times.lineOffsets[line];
+				char* out = start;
+
+				std::memcpy(out, label.data(), label.size());
+				out += label.size();
+				std::memcpy(out, clockLabel.data(), clockLabel.size());
+				out += clockLabel.size();
+				if (cache == nullptr)
+					out += isMilitary ? clock.formatTimeMilitary(out) : clock.formatTime(out);
+				else
+					out += isMilitary ? cache->formatTimeMilitary(clock, out) : cache->formatTime(clock, out);
+
+				times.lines[line] = std::string_view(start, out - start);
+			}
+		}
+		};
+
+	// Each render worker keeps its own cache, as caches are not shared between threads
+	if (isRenderCaching) {
+		while (renderCaches.size() < workerCount) renderCaches.push_back(std::make_unique<RenderCache>());
+	}
+
+	const auto getCache = [this](size_t worker) { return isRenderCaching ? renderCaches[worker].get() : nullptr; };
+
+	if (workerCount <= 1) {
+		renderRng(0, timepieces.size(), getCache(0));
+
+		return;
+	}
+
+	std::vector<std::future<void>> workers;
+	size_t first = 0;
+
+	workers.reserve(workerCount);
+
+	for (size_t worker = 1; worker <= workerCount && first < timepieces.size(); ++worker) {
+		const size_t lineTarget = lineCount * worker / workerCount;
+		const size_t last = worker == workerCount ? timepieces.size() :
+			std::max(first + 1, static_cast<size_t>(std::lower_bound(times.orreryLines.begin(),
+				times.orreryLines.end() - 1, lineTarget) - times.orreryLines.begin()));
+
+		workers.push_back(std::async(std::launch::async, renderRng, first, last, getCache(worker - 1)));
+		first = last;
+	}
+
+	for (std::future<void>& worker : workers) worker.get();
+}
+
+void GalacticTimepiece::layoutRender(RenderedTimes& times, bool isMilitary) const {
+	const size_t currentRevision = getRevision();
+
+	if (times.source == this && times.revision == currentRevision && times.isMilitary == isMilitary) return;
+
+	size_t offset = 0;
+
+	times.orreryLines.clear();
+	times.lineOffsets.clear();
+
+	for (const auto& [labelId, timepiece] : timepieces) {
+		const size_t labelSize = LabelPool::get(labelId).size();
+
+		times.orreryLines.push_back(times.lineOffsets.size());
+
+		for (size_t index = 0; index < timepiece->getSize(); ++index) {
+			const DayProfile& profile = timepiece->getClockAt(index).getProfile();
+
+			times.lineOffsets.push_back(offset);
+			offset += labelSize + timepiece->getLabelAt(index).size() +
+				(isMilitary ? profile.militaryTimeWidth : profile.standardTimeWidth);
+		}
+	}
+
+	times.orreryLines.push_back(times.lineOffsets.size());
+	times.buffer.assign(offset, ' ');
+	times.lines.assign(times.lineOffsets.size(), std::string_view());
+	times.source = this;
+	times.revision = currentRevision;
+	times.isMilitary = isMilitary;
+}
+
 void GalacticTimepiece::deleteTimepieces() {
-	for (std::pair<std::string, OrreryTimepiece*>& timepiece : timepieces) {
+	for (std::pair<LabelPool::Id, OrreryTimepiece*>& timepiece : timepieces) {
 		if (timepiece.second != nullptr) {
 			delete timepiece.second;
 			timepiece.second = nullptr;
@@ -1,8 +1,18 @@
 #ifndef GALACTIC_TIMEPIECE_H
 #define GALACTIC_TIMEPIECE_H
 
+#include "cacheline.h"
 #include "celestialtimepiece.h"
+#include "clocksnapshot.h"
 #include "orrerytimepiece.h"
+#include "rendercache.h"
+#include "renderedtimes.h"
+#include "tickplan.h"
+#include "timesource.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <utility>
@@ -12,33 +22,103 @@
 // A collection of OrreryTimepieces that keeps track of a galaxy or galaxy group's time
 class GalacticTimepiece : public CelestialTimepiece {
 public:
-	GalacticTimepiece() : running(false) {}
-
 	~GalacticTimepiece();
 
 	size_t getSize() const;
 
-	void add(const std::string& label, OrreryTimepiece* timepiece);
+	size_t getRevision() const override;
+
+	// Returns whether the galaxy took ownership, which it does not when the label is already in use
+	bool add(const std::string& label, OrreryTimepiece* timepiece);
 
 	OrreryTimepiece& getTimepiece(const std::string& searchLabel);
 
+	// Takes an orrery out of the galaxy and hands its ownership to the caller
+	OrreryTimepiece* remove(const std::string& searchLabel);
+
+	size_t getTimepieceCount() const { return timepieces.size(); }
+
+	std::string_view getLabelAt(size_t index) const { return LabelPool::get(timepieces[index].first); }
+
+	const OrreryTimepiece& getTimepieceAt(size_t index) const { return *timepieces[index].second; }
+
 	void clear();
 
+	void snapshot(ClockSnapshot& clockSnapshot);
+
+	void getDayPhases(std::vector<std::uint32_t>& phases);
+
+	void setDayPhases(const std::vector<std::uint32_t>& phases);
+
+	// Reprofiles matching clocks in every orrery between ticks, so it is safe while the galaxy is ticking
+	size_t reprofile(DayProfile::Id fromProfileId, DayProfile::Id toProfileId);
+
 	std::vector<std::string> getTimesMilitary();
 
 	std::vector<std::string> getTimes() override;
 
+	MemoryUsage memoryUsage() const override;
+
+	void compileTickPlan(TickPlan& plan) override;
+
+	const TickPlan& getTickPlan() const { return tickPlan; }
+
+	void renderTimesMilitary(RenderedTimes& times);
+
+	void renderTimes(RenderedTimes& times);
+
+	// Rendering memoizes times shared by clocks with the same profile and time unless disabled
+	void setRenderCaching(bool isEnabled);
+
+	std::uint64_t getRenderCacheHitCount();
+
+	std::uint64_t getRenderCacheMissCount();
+
+	void setTickThreadCount(size_t count) { tickThreadCount = count; }
+
+	size_t getTickThreadCount() const { return tickThreadCount; }
+
+	void setTimeSource(TimeSource* source);
+
+	std::uint64_t getTickCount() const { return tickCount; }
+
+	// Listeners run on the ticking thread while the galaxy holds its tick lock, so they may read clocks
+	// directly but must not call a galaxy method that locks or stops ticking, such as snapshot, getTimes
+	// or addTickListener, which would deadlock. Whatever they do lengthens every tick
+	size_t addTickListener(std::function<void(std::uint64_t)> listener);
+
+	void removeTickListener(size_t listenerId);
+
 	void tick() override;
 
 	void startTicking();
 
 	void stopTicking();
 
+	void simulate(std::uint64_t ticks);
+
 private:
-	std::vector<std::pair<std::string, OrreryTimepiece*>> timepieces;
+	std::vector<std::pair<LabelPool::Id, OrreryTimepiece*>> timepieces;
+	std::vector<std::pair<size_t, std::function<void(std::uint64_t)>>> tickListeners;
+	TickPlan tickPlan;
+	std::vector<std::unique_ptr<RenderCache>> renderCaches;
 	std::future<void> tickingFuture;
 	std::mutex mtx;
-	bool running;
+	TimeSource* timeSource = &SteadyTimeSource::getInstance();
+	PaddedAtomic<std::uint64_t> tickCount = 0;
+	PaddedAtomic<bool> running = false;
+	size_t revision = 0;
+	size_t tickThreadCount = 2;
+	size_t nextListenerId = 0;
+	bool isRenderCaching = true;
+
+	void takeSnapshot(ClockSnapshot& clockSnapshot) const;
+
+	void render(RenderedTimes& times, bool isMilitary);
+
+	void layoutRender(RenderedTimes& times, bool isMilitary) const;
+
+	RenderCache& getTimesCache();
 
 	void deleteTimepieces();
 };
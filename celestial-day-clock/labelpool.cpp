@@ -0,0 +1,121 @@
+#include "labelpool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr size_t labelChunkSize = 16 * 1024;
+static constexpr size_t maxLabelChunks = 4 * 1024;
+
+// Label bytes live in fixed blocks and IDs in fixed-capacity chunks so published views stay valid
+struct LabelPoolRegistry {
+	std::mutex mtx;
+	std::unordered_map<std::string_view, LabelPool::Id> ids;
+	std::array<std::unique_ptr<std::vector<std::string_view>>, maxLabelChunks> chunks;
+	std::vector<std::unique_ptr<char[]>> blocks;
+	size_t blockCapacity = 0;
+	size_t blockUsed = 0;
+	size_t poolBytes = 0;
+	std::atomic<size_t> count = 0;
+};
+
+static LabelPoolRegistry& getRegistry() {
+	static LabelPoolRegistry registry;
+
+	return registry;
+}
+
+static char* allocateLabelBytes(LabelPoolRegistry& registry, size_t size) {
+	if (registry.blocks.empty() || size > registry.blockCapacity - registry.blockUsed) {
+		const size_t newBlockSize = std::max(size, LabelPool::blockSize);
+
+		registry.blocks.push_back(std::make_unique<char[]>(newBlockSize));
+		registry.blockCapacity = newBlockSize;
+		registry.blockUsed = 0;
+		registry.poolBytes += newBlockSize;
+	}
+
+	char* const bytes = registry.blocks.back().get() + registry.blockUsed;
+
+	registry.blockUsed += size;
+
+	return bytes;
+}
+
+LabelPool::Id LabelPool::intern(std::string_view label) {
+	LabelPoolRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mtx);
+	const auto itr = registry.ids.find(label);
+
+	if (itr != registry.ids.end()) return itr->second;
+
+	const size_t count = registry.count.load(std::memory_order_relaxed);
+
+	if (count >= labelChunkSize * maxLabelChunks) throw std::length_error("Label pool capacity exceeded");
+
+	std::unique_ptr<std::vector<std::string_view>>& chunk = registry.chunks[count / labelChunkSize];
+
+	if (!chunk) {
+		chunk = std::make_unique<std::vector<std::string_view>>();
+		chunk->reserve(labelChunkSize);
+	}
+
+	char* const bytes = allocateLabelBytes(registry, label.size());
+
+	std::memcpy(bytes, label.data(), label.size());
+
+	const std::string_view pooledLabel(bytes, label.size());
+	const Id id = static_cast<Id>(count);
+
+	chunk->push_back(pooledLabel);
+	registry.ids.emplace(pooledLabel, id);
+	registry.count.store(count + 1, std::memory_order_release);
+
+	return id;
+}
+
+bool LabelPool::find(std::string_view label, Id& id) {
+	LabelPoolRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mtx);
+	const auto itr = registry.ids.find(label);
+
+	if (itr == registry.ids.end()) return false;
+
+	id = itr->second;
+
+	return true;
+}
+
+std::string_view LabelPool::get(Id id) {
+	const LabelPoolRegistry& registry = getRegistry();
+
+	if (id >= registry.count.load(std::memory_order_acquire))
+		throw std::out_of_range("Label " + std::to_string(id) + " not found");
+
+	return (*registry.chunks[id / labelChunkSize])[id % labelChunkSize];
+}
+
+std::string LabelPool::prefix(Id id, std::string_view text) {
+	const std::string_view label = get(id);
+	std::string prefixed(label.size() + text.size(), '\0');
+
+	std::memcpy(prefixed.data(), label.data(), label.size());
+	std::memcpy(prefixed.data() + label.size(), text.data(), text.size());
+
+	return prefixed;
+}
+
+size_t LabelPool::getCount() { return getRegistry().count.load(std::memory_order_acquire); }
+
+size_t LabelPool::getPoolBytes() {
+	LabelPoolRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mtx);
+
+	return registry.poolBytes;
+}
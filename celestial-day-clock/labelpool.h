@@ -0,0 +1,30 @@
+#ifndef LABEL_POOL_H
+#define LABEL_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/* An interning table for timepiece labels that stores each distinct label's bytes once in a
+   contiguous pool and hands out a compact ID for it */
+class LabelPool {
+public:
+	using Id = std::uint32_t;
+
+	static constexpr size_t blockSize = 64 * 1024;
+
+	static Id intern(std::string_view label);
+
+	static bool find(std::string_view label, Id& id);
+
+	static std::string_view get(Id id);
+
+	static std::string prefix(Id id, std::string_view text);
+
+	static size_t getCount();
+
+	static size_t getPoolBytes();
+};
+
+#endif
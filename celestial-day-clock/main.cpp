@@ -1,10 +1,37 @@
 #include "cdc_test.h"
 #include "globals.h"
+#include "cacheline.h"
 #include "numeric_limits.h"
 #include "celestialdayclock.h"
+#include "clockharness.h"
+#include "clockhistory.h"
+#include "clockloader.h"
+#include "clockranking.h"
+#include "columnarlog.h"
+#include "dayphase.h"
+#include "dayprofile.h"
+#include "epochdayclock.h"
 #include "orrerytimepiece.h"
 #include "galactictimepiece.h"
+#include "labelpool.h"
+#include "offsetclockview.h"
+#include "rendercache.h"
+#include "renderedtimes.h"
+#include "shardedgalaxy.h"
+#include "sharedclockstate.h"
+#include "statictimepiece.h"
+#include "replaylog.h"
+#include "terminalrenderer.h"
+#include "tickplan.h"
+#include "tickscheduler.h"
+#include "tracer.h"
+#include "timeofdayindex.h"
+#include "timeserver.h"
+#include "timesource.h"
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <cassert>
 #include <string>
@@ -14,8 +41,19 @@
 #include <map>
 #include <unordered_map>
 #include <memory>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
 #include <thread>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 static void testSimplifiedNumericLimits();
 
 static void testNewNumericLimits();
@@ -36,11 +74,87 @@ static void testStandardTime4(CelestialDayClock* clock);
 static void testStandardTime5(CelestialDayClock* clock);
 static void testCDCStandardTime();
 
+static void testDayProfile();
+
+static void testLabelPool();
+
 static void testOrreryTimepiece();
 
 static void testGalacticTimepiece();
 
+static void testReplayLog();
+
+static void testGalacticRender();
+
+static GalacticTimepiece* createRandomGalacticTimepiece(int orreryCount, int clockCount);
+static void testTimeOfDayIndex();
+
+static void testDayPhase();
+
+static void testTerminalRenderer();
+
+static void testOffsetClockView();
+
+static void testRenderedViews();
+
+static void testClockSlabs();
+
+static void testClockHarness();
+
+static void testTracer();
+
+static void testMemoryUsage();
+
+static void testTickPlan();
+
+static void testStaticTimepiece();
+
+static void testEpochDayClock();
+
+static void testRewind();
+
+static void testClockHistory();
+
+static void testColumnarLog();
+
+static void testClockLoader();
+
+static void testRenderCache();
+
+static void testClockRanking();
+
+static void testReprofile();
+
+#ifdef __linux__
+static void testTimeServer();
+
+static void testSharedClockState();
+
+static void testShardedGalaxy();
+#endif
+
+static TickTask awaitTicks(TickScheduler& scheduler, int tickCount, std::uint64_t& lastTick);
+static void testTickScheduler();
+
 static void displayCelestialTimepiece(CelestialTimepiece* timepiecePtr);
+static GalacticTimepiece* createBenchGalacticTimepiece(bool isPacked, int clockCount = cdc_test::benchClockCount);
+static double measureTicks(GalacticTimepiece& timepiece, size_t threadCount);
+template<class Tick>
+static double measureTickCost(Tick tick, size_t clockCount);
+static void benchmarkDispatch(GalacticTimepiece& timepiece);
+static void scatterClockTimes(GalacticTimepiece& timepiece);
+static void benchmarkRenderCache();
+static void benchmarkClockRanking();
+#ifdef CDC_TRACE
+static void traceTick(GalacticTimepiece& timepiece);
+#endif
+static void benchmarkTickLayouts();
+static void reportMemoryUsage();
+static void loadGalacticTimepiece();
+#ifdef __linux__
+static void benchmarkShards();
+static void serveGalacticTimepiece();
+#endif
 static void displayPlanetaryCDCMenu();
 static OrreryTimepiece* createOrreryTimepiece();
 static GalacticTimepiece* createGalacticTimepiece();
@@ -53,8 +167,37 @@ int main() {
 	testNewNumericLimits();
 	testCDCMilitaryTime();
 	testCDCStandardTime();
+	testDayProfile();
+	testLabelPool();
 	testOrreryTimepiece();
 	testGalacticTimepiece();
+	testReplayLog();
+	testGalacticRender();
+	testTickScheduler();
+	testTimeOfDayIndex();
+	testDayPhase();
+	testTerminalRenderer();
+	testOffsetClockView();
+	testRenderedViews();
+	testClockSlabs();
+	testClockHarness();
+	testTracer();
+	testMemoryUsage();
+	testTickPlan();
+	testStaticTimepiece();
+	testEpochDayClock();
+	testRewind();
+	testClockHistory();
+	testColumnarLog();
+	testClockLoader();
+	testRenderCache();
+	testClockRanking();
+	testReprofile();
+#ifdef __linux__
+	testTimeServer();
+	testSharedClockState();
+	testShardedGalaxy();
+#endif
 	// Demonstrating the use of the new classes
 	displayCDCMenu();
 
@@ -319,6 +462,43 @@ static void testCDCStandardTime() {
 	std::cout << "\nEnd celestial day clock standard time test." << std::endl;
 }
 
+static void testDayProfile() {
+	constexpr int minutesPerHour = cdc_test::senaryRadix * cdc_test::decimalRadix;
+	const CelestialDayClock clock0(cdc_test::hours, cdc_test::minutes);
+	const CelestialDayClock clock1(cdc_test::hours, cdc_test::minutes + 1);
+	const CelestialDayClock clock2(cdc_test::hours, 0);
+
+	std::cout << "\n\nTesting shared day profiles..." << std::endl;
+	assert(clock0.getProfileId() == clock1.getProfileId());
+	assert(&clock0.getProfile() == &clock1.getProfile());
+	assert(clock0.getProfileId() != clock2.getProfileId());
+	assert(clock0.getProfile().daySeconds ==
+		(cdc_test::hours * minutesPerHour + cdc_test::expectedMinutes) * minutesPerHour);
+	assert(clock2.getProfile().halfDaySeconds ==
+		cdc_test::hours / 2 * minutesPerHour * minutesPerHour);
+	assert(clock0.getTimeMilitary().size() <=
+		static_cast<size_t>(clock0.getProfile().militaryTimeWidth));
+	assert(clock0.getTime().size() <= static_cast<size_t>(clock0.getProfile().standardTimeWidth));
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testLabelPool() {
+	const std::string label = "Star System A - ";
+	const LabelPool::Id labelId = LabelPool::intern(label);
+	const size_t labelCount = LabelPool::getCount();
+	LabelPool::Id foundId = 0;
+
+	std::cout << "\n\nTesting label pool..." << std::endl;
+	assert(LabelPool::intern(std::string(label)) == labelId);
+	assert(LabelPool::getCount() == labelCount);
+	assert(LabelPool::get(labelId) == label);
+	assert(LabelPool::get(labelId).data() == LabelPool::get(LabelPool::intern(label)).data());
+	assert(LabelPool::find(label, foundId) && foundId == labelId);
+	assert(!LabelPool::find("Star System Z - ", foundId));
+	assert(LabelPool::prefix(labelId, cdc_test::zeroTimeString) == label + cdc_test::zeroTimeString);
+	std::cout << cdc_test::passed << std::endl;
+}
+
 static void testOrreryTimepiece() {
 	OrreryTimepiece* timepiece = new OrreryTimepiece();
 	int cdcCount = 0;
@@ -346,6 +526,9 @@ static void testGalacticTimepiece() {
 	GalacticTimepiece* timepiece = new GalacticTimepiece();
 	OrreryTimepiece* orreryTimepiece0 = new OrreryTimepiece();
 	OrreryTimepiece* orreryTimepiece1 = new OrreryTimepiece();
+	CelestialDayClock referenceClock0(cdc_test::hours, 0);
+	CelestialDayClock referenceClock1(cdc_test::hours, cdc_test::minutes);
+	VirtualTimeSource virtualTime;
 
 	std::cout << "\n\nTesting galactic timepiece..." << std::endl;
 	orreryTimepiece0->add("0. ", new CelestialDayClock(cdc_test::hours, 0));
@@ -364,136 +547,2033 @@ static void testGalacticTimepiece() {
 		cdc_test::oneSecondTimeString);
 	assert(timepiece->getTimesMilitary()[0] == "0. 0. " + cdc_test::oneSecondTimeString);
 	assert(timepiece->getTimesMilitary().back() == "1. 1. " + cdc_test::oneSecondTimeString);
+
+	const std::uint64_t startTick = timepiece->getTickCount();
+
+	referenceClock0.setSecondsDigit2(1);
+	referenceClock1.setSecondsDigit2(1);
+	timepiece->setTimeSource(&virtualTime);
 	timepiece->startTicking();
-	std::this_thread::sleep_for(std::chrono::seconds(1));
+
+	while (timepiece->getTickCount() < startTick + cdc_test::threadedTicks) std::this_thread::yield();
+
 	assert(timepiece->getSize() == orreryTimepiece0->getSize() + orreryTimepiece1->getSize());
-	std::this_thread::sleep_for(std::chrono::seconds(1));
-	assert(timepiece->getTimesMilitary()[0] != "0. 0. " + cdc_test::oneSecondTimeString);
-	assert(timepiece->getTimesMilitary().back() != "1. 1. " + cdc_test::oneSecondTimeString);
+
+	const std::vector<std::string> times = timepiece->getTimesMilitary();
+
+	for (std::uint64_t tick = startTick; tick < timepiece->getTickCount(); ++tick) {
+		referenceClock0.tick();
+		referenceClock1.tick();
+	}
+
+	assert(times[0] != "0. 0. " + cdc_test::oneSecondTimeString);
+	assert(times.back() != "1. 1. " + cdc_test::oneSecondTimeString);
+	assert(times[0] == "0. 0. " + referenceClock0.getTimeMilitary());
+	assert(times.back() == "1. 1. " + referenceClock1.getTimeMilitary());
 	delete timepiece;
 	std::cout << cdc_test::passed << std::endl;
 }
 
-static void displayCelestialTimepiece(CelestialTimepiece* timepiecePtr) {
-	const std::unique_ptr<CelestialTimepiece> timepiece(timepiecePtr);
-	std::chrono::time_point<std::chrono::steady_clock> nextTick =
-		std::chrono::steady_clock::now() + std::chrono::seconds(1);
+static void testReplayLog() {
+	constexpr std::uint64_t secondsPerDay = 24 * 60 * 60;
+	GalacticTimepiece timepiece;
+	GalacticTimepiece replayedTimepiece;
+	VirtualTimeSource virtualTime;
+	std::stringstream log;
+	const auto start = std::chrono::steady_clock::now();
 
-	std::cout << std::endl;
+	std::cout << "\n\nTesting simulated time and replay log..." << std::endl;
+	timepiece.setTimeSource(&virtualTime);
+	timepiece.setTickThreadCount(1);
+
+	// State from before recording starts is logged first
+	OrreryTimepiece* const existingTimepiece = new OrreryTimepiece();
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+
+	existingTimepiece->emplace("0. ", marsDay.hours, marsDay.minutes)->setSecondsOfDay(std::rand());
+	timepiece.add("Existing: ", existingTimepiece);
+
+	{
+		ReplayRecorder recorder(timepiece, log);
+		std::vector<std::uint32_t> phases;
+
+		recorder.addTimepiece("0. ");
+		recorder.addClock("0. ", "0. ", cdc_test::hours, 0);
+		recorder.addClock("0. ", "1. ", cdc_test::hours, cdc_test::minutes);
+		timepiece.simulate(secondsPerDay * cdc_test::simulatedDays);
+		recorder.setTime("0. ", "1. ", cdc_test::time3.hours,
+			cdc_test::time3.minutesDigit1, cdc_test::time3.minutesDigit2,
+			cdc_test::time3.secondsDigit1, cdc_test::time3.secondsDigit2);
+		recorder.rewind("0. ", "0. ", cdc_test::replayRewindSeconds);
+		assert(recorder.reprofile(cdc_test::hours, 0, marsDay.hours, marsDay.minutes) == 1);
+		timepiece.getDayPhases(phases);
+		phases.front() += static_cast<std::uint32_t>(DayPhase::one / 2);
+		recorder.setDayPhases(phases);
+		recorder.removeTimepiece("Existing: ");
+		timepiece.simulate(secondsPerDay);
+	}
+
+	assert(virtualTime.now() - TimeSource::TimePoint() ==
+		std::chrono::seconds(secondsPerDay * (cdc_test::simulatedDays + 1)));
+	assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(secondsPerDay));
+	replayedTimepiece.setTickThreadCount(1);
+	assert(ReplayPlayer::replay(log, replayedTimepiece) == 11);
+	assert(replayedTimepiece.getTickCount() == timepiece.getTickCount());
+	assert(replayedTimepiece.getTimesMilitary() == timepiece.getTimesMilitary());
+	assert(replayedTimepiece.getTimes() == timepiece.getTimes());
+
+	// A corrupt label length fails as a truncated log instead of allocating what it claims
+	std::string corruptLog(ReplayRecorder::magic, sizeof(ReplayRecorder::magic));
+	GalacticTimepiece corruptTimepiece;
+	std::string error;
+
+	corruptLog += { static_cast<char>(ReplayRecorder::version), static_cast<char>(ReplayEvent::AddTimepiece) };
+	corruptLog.append(sizeof(std::uint32_t), static_cast<char>(0xFF));
+
+	std::istringstream corruptIn(corruptLog);
 
 	try {
-		for (const std::string& time : timepiece->getTimes()) {
-			std::cout << time << std::endl;
-		}
+		ReplayPlayer::replay(corruptIn, corruptTimepiece);
+	}
+	catch (const std::runtime_error& e) {
+		error = e.what();
+	}
 
-		timepiece->tick();
+	assert(error == "Truncated replay log");
+	std::cout << cdc_test::passed << std::endl;
+}
 
-		while (true) {
-			std::this_thread::sleep_until(nextTick);
-			nextTick += std::chrono::seconds(1);
+static void testGalacticRender() {
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	RenderedTimes times;
+	RenderedTimes militaryTimes;
 
-			for (const std::string& time : timepiece->getTimes()) {
-				std::cout << time << std::endl;
-			}
+	std::cout << "\n\nTesting parallel galactic rendering..." << std::endl;
 
-			timepiece->tick();
+	for (int orreryIndex = 0; orreryIndex < cdc_test::renderOrreryCount; ++orreryIndex) {
+		OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+
+		for (int clockIndex = 0; clockIndex < cdc_test::renderClockCount; ++clockIndex) {
+			const CelestialDay& day =
+				planetDayLengths.at(static_cast<PlanetChoice>(clockIndex % PlanetChoice::MaxChoice + 1));
+			CelestialDayClock* clock = new CelestialDayClock(day.hours, day.minutes);
+
+			clock->setHours(std::rand() % day.hours);
+			clock->setMinutesDigit1(std::rand() % cdc_test::senaryRadix);
+			clock->setSecondsDigit2(std::rand() % cdc_test::decimalRadix);
+			orreryTimepiece->add(std::to_string(clockIndex) + ". ", clock);
 		}
+
+		timepiece->add(std::to_string(orreryIndex) + ". ", orreryTimepiece);
 	}
-	catch (const std::exception& e) {
-		std::cerr << "Exception in displayCelestialTimepiece: " << e.what() << std::endl;
+
+	timepiece->renderTimes(times);
+	timepiece->renderTimesMilitary(militaryTimes);
+	assert(times.getSize() == timepiece->getSize());
+
+	const std::vector<std::string> expectedMilitaryTimes = timepiece->getTimesMilitary();
+
+	assert(std::equal(militaryTimes.begin(), militaryTimes.end(), expectedMilitaryTimes.begin(),
+		expectedMilitaryTimes.end()));
+
+	const char* const firstLine = times[0].data();
+
+	timepiece->tick();
+	timepiece->renderTimes(times);
+	assert(times[0].data() == firstLine);
+
+	const std::vector<std::string> expectedTimes = timepiece->getTimes();
+
+	assert(std::equal(times.begin(), times.end(), expectedTimes.begin(), expectedTimes.end()));
+
+	// Longer days need wider slots, including on the last line at the end of the buffer
+	const std::string lastOrreryLabel = std::to_string(cdc_test::renderOrreryCount - 1) + ". ";
+	CelestialDayClock& lastClock = timepiece->getTimepiece(lastOrreryLabel).getClockAt(cdc_test::renderClockCount - 1);
+
+	lastClock.setBodyMaximums(cdc_test::widenedBodyHours, 0);
+	lastClock.setHours(cdc_test::widenedBodyHours - 1);
+	timepiece->renderTimes(times);
+	timepiece->renderTimesMilitary(militaryTimes);
+	assert(std::vector<std::string>(times.begin(), times.end()) == timepiece->getTimes());
+	assert(std::vector<std::string>(militaryTimes.begin(), militaryTimes.end()) == timepiece->getTimesMilitary());
+	delete timepiece;
+
+	// Removing an orrery must change the revision even when the other orreries have been revised more
+	GalacticTimepiece removalTimepiece;
+	OrreryTimepiece* const smallOrrery = new OrreryTimepiece();
+	OrreryTimepiece* const largeOrrery = new OrreryTimepiece();
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+
+	smallOrrery->emplace("1. ", earthDay.hours, earthDay.minutes);
+	largeOrrery->emplace("1. ", earthDay.hours, earthDay.minutes);
+	largeOrrery->emplace("2. ", earthDay.hours, earthDay.minutes);
+	removalTimepiece.add("X: ", smallOrrery);
+	removalTimepiece.add("Y: ", largeOrrery);
+	removalTimepiece.renderTimesMilitary(militaryTimes);
+
+	const size_t revisionBeforeRemoval = removalTimepiece.getRevision();
+
+	delete removalTimepiece.remove("X: ");
+	assert(removalTimepiece.getRevision() > revisionBeforeRemoval);
+	removalTimepiece.renderTimesMilitary(militaryTimes);
+	assert(std::vector<std::string>(militaryTimes.begin(), militaryTimes.end()) == removalTimepiece.getTimesMilitary());
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static TickTask awaitTicks(TickScheduler& scheduler, int tickCount, std::uint64_t& lastTick) {
+	for (int tick = 0; tick < tickCount; ++tick) {
+		lastTick = co_await scheduler.nextTick();
 	}
 }
 
-static void displayPlanetaryCDCMenu() {
-	const std::string range =
-		std::to_string(PlanetChoice::Mercury) + " and " + std::to_string(PlanetChoice::MaxChoice);
-	int choice = 0;
-	bool isValidChoice = false;
+static void testTickScheduler() {
+	GalacticTimepiece timepiece;
+	OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+	TickScheduler scheduler(std::chrono::milliseconds(cdc_test::schedulerIntervalMilliseconds));
+	std::uint64_t lastTick = 0;
 
-	while (!isValidChoice) {
-		isValidChoice = true;
-		std::cout << "\n\nChoose a planet to display its standard clock: " << std::endl;
+	std::cout << "\n\nTesting coroutine tick scheduler..." << std::endl;
+	orreryTimepiece->add("0. ", new CelestialDayClock(cdc_test::hours, 0));
+	timepiece.add("0. ", orreryTimepiece);
+	scheduler.add(&timepiece);
+	assert(timepiece.getTickThreadCount() == 1);
 
-		for (const auto& [planetChoice, planetName] : planetNames) {
-			std::cout << planetChoice << ". " << planetName << std::endl;
+	const TickTask task = awaitTicks(scheduler, cdc_test::scheduledTicks, lastTick);
+
+	assert(!task.isDone());
+
+	while (!task.isDone()) scheduler.runOnce();
+
+	task.rethrow();
+
+	const CelestialDayClock& clock = timepiece.getTimepiece("0. ").getClock("0. ");
+
+	assert(lastTick == scheduler.getTickCount());
+	assert(lastTick >= static_cast<std::uint64_t>(cdc_test::scheduledTicks));
+	assert(static_cast<std::uint64_t>(clock.getSecondsDigit1() * cdc_test::decimalRadix +
+		clock.getSecondsDigit2()) == lastTick);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static GalacticTimepiece* createRandomGalacticTimepiece(int orreryCount, int clockCount) {
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+
+	for (int orreryIndex = 0; orreryIndex < orreryCount; ++orreryIndex) {
+		OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+
+		for (int clockIndex = 0; clockIndex < clockCount; ++clockIndex) {
+			const CelestialDay& day =
+				planetDayLengths.at(static_cast<PlanetChoice>(clockIndex % PlanetChoice::MaxChoice + 1));
+			CelestialDayClock* clock = new CelestialDayClock(day.hours, day.minutes);
+
+			clock->setSecondsOfDay(std::rand() % clock->getProfile().daySeconds);
+			orreryTimepiece->add(std::to_string(clockIndex) + ". ", clock);
 		}
 
-		std::cin >> choice;
+		timepiece->add(std::to_string(orreryIndex) + ". ", orreryTimepiece);
+	}
 
-		if (std::cin.fail() ||
-			choice < PlanetChoice::Mercury || choice > PlanetChoice::MaxChoice) {
-			isValidChoice = false;
-			std::cin.clear();
-			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-			std::cout << "Invalid planet choice number. Please enter a choice number between "
-				+ range << std::endl;
+	return timepiece;
+}
+
+static void testTimeOfDayIndex() {
+	GalacticTimepiece* timepiece =
+		createRandomGalacticTimepiece(cdc_test::indexOrreryCount, cdc_test::indexClockCount);
+	VirtualTimeSource virtualTime;
+	TimeOfDayIndex index(*timepiece);
+	std::vector<size_t> expectedWindow;
+	std::vector<size_t> expectedPostMeridiem;
+	std::vector<size_t> expectedRollover;
+	size_t clockIndex = 0;
+
+	std::cout << "\n\nTesting time of day index..." << std::endl;
+	timepiece->setTimeSource(&virtualTime);
+	timepiece->setTickThreadCount(1);
+	timepiece->simulate(cdc_test::indexTicks);
+	assert(!index.isStale());
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece->getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece->getTimepieceAt(orreryIndex);
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index, ++clockIndex) {
+			const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+			CelestialDayClock copy(clock.getBodyMaximums()[0], clock.getBodyMaximums()[1]);
+
+			copy.setSecondsOfDay(clock.getSecondsOfDay());
+			assert(copy.getTimeMilitary() == clock.getTimeMilitary());
+
+			if (clock.getHours() == cdc_test::windowStartHours) expectedWindow.push_back(clockIndex);
+
+			if (clock.isPostMeridiem()) expectedPostMeridiem.push_back(clockIndex);
+
+			if (clock.getProfile().daySeconds - clock.getSecondsOfDay() <= cdc_test::rolloverWindowSeconds)
+				expectedRollover.push_back(clockIndex);
 		}
 	}
 
-	const std::unordered_map<PlanetChoice, CelestialDay>::const_iterator itr =
-		planetDayLengths.find(static_cast<PlanetChoice>(choice));
+	const auto sorted = [](std::vector<size_t> indices) {
+		std::sort(indices.begin(), indices.end());
 
-	if (itr != planetDayLengths.end())
-		displayCelestialTimepiece(new CelestialDayClock(itr->second.hours, itr->second.minutes));
+		return indices;
+		};
+
+	assert(sorted(index.findBetween({ cdc_test::windowStartHours, 0, 0 },
+		{ cdc_test::windowStartHours + 1, 0, 0 })) == expectedWindow);
+	assert(sorted(index.findMeridiem(true)) == expectedPostMeridiem);
+	assert(index.findMeridiem(false).size() + expectedPostMeridiem.size() == timepiece->getSize());
+	assert(sorted(index.findNearRollover(cdc_test::rolloverWindowSeconds)) == expectedRollover);
+	timepiece->getTimepiece("0. ").add("Extra. ", new CelestialDayClock(cdc_test::hours, 0));
+	assert(index.isStale());
+	index.rebuild();
+	assert(index.getSize() == timepiece->getSize());
+
+	std::vector<std::uint32_t> phases(timepiece->getSize(), 0);
+
+	timepiece->setDayPhases(phases);
+	assert(index.isStale());
+	index.rebuild();
+	assert(!index.isStale() && index.getSecondsOfDay(0) == 0);
+
+	CelestialDayClock& clock = timepiece->getTimepiece("0. ").getClock("Extra. ");
+	const size_t revision = timepiece->getRevision();
+
+	clock.setBodyMaximums(cdc_test::widenedBodyHours, 0);
+	assert(index.isStale() && timepiece->getRevision() != revision);
+	index.rebuild();
+	assert(!index.isStale());
+
+	// Epoch clocks follow the wall time rather than ticks, so bucket rotation cannot keep up with them
+	OrreryTimepiece* const epochTimepiece = new OrreryTimepiece();
+	CelestialDayClock* const base = epochTimepiece->emplace("Base: ", cdc_test::hours, 0);
+
+	epochTimepiece->add("View: ", new OffsetClockView(*base, cdc_test::viewOffsets[1]));
+	assert(epochTimepiece->isTickDriven());
+	epochTimepiece->add("Epoch: ", new EpochDayClock(*base, std::time(nullptr)));
+	assert(!epochTimepiece->isTickDriven());
+	timepiece->add("Epoch - ", epochTimepiece);
+	index.rebuild();
+	assert(index.isStale() && index.getSize() == timepiece->getSize());
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
 }
 
-static OrreryTimepiece* createOrreryTimepiece() {
-	OrreryTimepiece* timepiece = new OrreryTimepiece();
-	CelestialDayClock* clock = nullptr;
+static void testDayPhase() {
+	GalacticTimepiece* timepiece =
+		createRandomGalacticTimepiece(cdc_test::indexOrreryCount, cdc_test::indexClockCount);
+	std::vector<std::uint32_t> phases;
+	size_t clockIndex = 0;
+
+	std::cout << "\n\nTesting fixed-point day phases..." << std::endl;
 
 	for (const auto& [planetChoice, celestialDay] : planetDayLengths) {
-		clock = new CelestialDayClock(celestialDay.hours, celestialDay.minutes);
-		clock->setHours(std::rand() % 2);
-		clock->setMinutesDigit1(std::rand() % cdc_test::senaryRadix);
-		clock->setMinutesDigit2(std::rand() % cdc_test::decimalRadix);
-		clock->setSecondsDigit1(std::rand() % cdc_test::senaryRadix);
-		clock->setSecondsDigit2(std::rand() % cdc_test::decimalRadix);
-		timepiece->add(planetNames.at(planetChoice) + cdc_test::delimiter + ' ', clock);
+		const DayProfile& profile =
+			DayProfile::get(DayProfile::fromBodyMaximums(celestialDay.hours, celestialDay.minutes));
+
+		for (int sample = 0; sample < cdc_test::phaseSamples; ++sample) {
+			const int secondsOfDay = sample < profile.daySeconds / 2 ? sample : static_cast<int>(
+				(static_cast<std::uint64_t>(std::rand()) * RAND_MAX + std::rand()) % profile.daySeconds);
+			const std::uint32_t phase = DayPhase::fromSecondsOfDay(secondsOfDay, profile);
+
+			assert(phase == (static_cast<std::uint64_t>(secondsOfDay) << 32) / profile.daySeconds);
+			assert(DayPhase::toSecondsOfDay(phase, profile) == secondsOfDay);
+		}
 	}
 
-	return timepiece;
+	timepiece->getDayPhases(phases);
+	assert(phases.size() == timepiece->getSize());
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece->getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece->getTimepieceAt(orreryIndex);
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index)
+			assert(orreryTimepiece.getClockAt(index).getDayPhase() == phases[clockIndex++]);
+	}
+
+	timepiece->setDayPhases(std::vector<std::uint32_t>(phases.size(), DayPhase::one / 2));
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece->getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece->getTimepieceAt(orreryIndex);
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index) {
+			const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+
+			assert(clock.getSecondsOfDay() == clock.getProfile().halfDaySeconds);
+			assert(clock.isPostMeridiem());
+		}
+	}
+
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
 }
 
-static GalacticTimepiece* createGalacticTimepiece() {
-	GalacticTimepiece* timepiece = new GalacticTimepiece();
-	OrreryTimepiece* orreryTimepiece = createOrreryTimepiece();
+static void testTerminalRenderer() {
+	TerminalRenderer renderer(-1, cdc_test::terminalRows, cdc_test::terminalColumns);
+	std::vector<std::string> lines = { "Earth 10:00", "Mars 12:30" };
 
-	timepiece->add("Star System A - ", orreryTimepiece);
-	orreryTimepiece = createOrreryTimepiece();
-	timepiece->add("Star System B - ", orreryTimepiece);
+	size_t rows = 0;
+	size_t columns = 0;
 
-	return timepiece;
+	std::cout << "\n\nTesting terminal renderer..." << std::endl;
+	TerminalRenderer::getTerminalSize(-1, rows, columns);
+	assert(rows == TerminalRenderer::defaultRows && columns == TerminalRenderer::defaultColumns);
+	renderer.draw(lines);
+	assert(renderer.getFrame() == "\x1b[?25l\x1b[2J\x1b[1;1HEarth 10:00\x1b[2;1HMars 12:30");
+	renderer.draw(lines);
+	assert(renderer.getFrame().empty());
+	lines[0] = "Earth 10:01";
+	lines[1] = "Mars 9:30";
+	renderer.draw(lines);
+	assert(renderer.getFrame() == "\x1b[1;11H1\x1b[2;6H9:30 ");
+	lines.push_back("Venus 1:00:00 PM");
+	lines.push_back("Pluto 2:00");
+	renderer.setFirstLine(lines.size());
+	renderer.draw(lines);
+	assert(renderer.getFirstLine() == 2);
+	assert(renderer.getFrame() == "\x1b[1;1HVenus 1:00:0\x1b[2;1HPluto 2:00\x1b[3;1H-- Lines 3-4");
+	renderer.redraw();
+	renderer.draw(lines);
+	assert(renderer.getFrame().starts_with("\x1b[?25l\x1b[2J"));
+	std::cout << cdc_test::passed << std::endl;
 }
 
-static void displayCDCMenu() {
-	constexpr int planetChoice = 1;
-	constexpr int orreryChoice = planetChoice + 1;
-	constexpr int galacticChoice = orreryChoice + 1;
-	const std::string range =
-		std::to_string(planetChoice) + " and " + std::to_string(galacticChoice);
-	int choice = 0;
-	bool isValidChoice = false;
+#ifdef __linux__
+static void testTimeServer() {
+	GalacticTimepiece* timepiece =
+		createRandomGalacticTimepiece(cdc_test::indexOrreryCount, cdc_test::indexClockCount);
+	const std::string socketPath = "/tmp/cdc-test-" + std::to_string(std::rand()) + ".sock";
 
-	while (!isValidChoice) {
-		isValidChoice = true;
-		std::cout << "\n\nChoose to display a planet clock or an orrery timepiece: " << std::endl;
-		std::cout << std::to_string(planetChoice) + ". Display a planet clock" << std::endl;
-		std::cout << std::to_string(orreryChoice) + ". Display an orrery timepiece" << std::endl;
-		std::cout << std::to_string(galacticChoice) + ". Display a galactic timepiece" << std::endl;
-		std::cin >> choice;
+	std::cout << "\n\nTesting time server..." << std::endl;
+	timepiece->setTickThreadCount(1);
 
-		if (std::cin.fail() || choice < planetChoice || choice > galacticChoice) {
-			isValidChoice = false;
-			std::cin.clear();
-			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-			std::cout << "Invalid menu choice number. Please enter a choice number between " +
-				range << std::endl;
+	{
+		TimeServer server(*timepiece);
+		const std::uint16_t port = server.listenTcp(0);
+
+		server.listenUnix(socketPath);
+
+		TimeLoadGenerator subscribers(port);
+		TimeLoadGenerator requester(socketPath);
+		const auto pump = [&](const auto& isDone) {
+			for (int attempt = 0; attempt < cdc_test::serverAttempts && !isDone(); ++attempt) {
+				server.runOnce(cdc_test::serverPollMilliseconds);
+				subscribers.poll(0);
+				requester.poll(0);
+			}
+
+			assert(isDone());
+			};
+
+		subscribers.connect(cdc_test::serverSubscribers);
+		subscribers.send("SUBSCRIBE");
+		requester.connect(1);
+		requester.send("GET 1/2\nALL\nGET 1/999\nPING");
+		pump([&]() { return subscribers.getFrameCount() == cdc_test::serverSubscribers &&
+			requester.getReplies().size() == 3 && requester.getFrameCount() == 1; });
+
+		const std::vector<std::string> times = timepiece->getTimes();
+
+		assert(server.getClientCount() == cdc_test::serverSubscribers + 1);
+		assert(server.getSubscriberCount() == cdc_test::serverSubscribers);
+		assert(server.getRenderCount() == 1);
+		assert(requester.getReplies()[0] == "TIME " + times[cdc_test::indexClockCount + 2]);
+		assert(requester.getReplies()[1] == "ERROR Unknown label path 1/999");
+		assert(requester.getReplies()[2] == "ERROR Unknown request PING");
+		assert(requester.getLastFrame() == times);
+
+		for (int tick = 1; tick <= cdc_test::serverTicks; ++tick) {
+			timepiece->tick();
+			pump([&]() { return subscribers.getFrameCount() == cdc_test::serverSubscribers * (tick + 1); });
+		}
+
+		assert(server.getRenderCount() == 1 + cdc_test::serverTicks);
+		assert(server.getDroppedFrameCount() == 0);
+		assert(subscribers.getLastFrame() == timepiece->getTimes());
+
+		TimeLoadGenerator pipeliner(socketPath);
+		std::string requests;
+
+		for (size_t request = 0; request < cdc_test::serverPipelinedRequests; ++request) requests += "ALL\n";
+
+		requests.pop_back();
+		pipeliner.connect(1);
+		pipeliner.send(requests);
+
+		// Nothing reads the replies yet, so the server has to stop reading the requests
+		for (int attempt = 0; attempt < cdc_test::serverAttempts; ++attempt) server.runOnce(0);
+
+		assert(server.getQueuedReplyCount() > 0 && server.getQueuedReplyCount() <= TimeServer::maxPendingReplies);
+
+		for (int attempt = 0; attempt < cdc_test::serverAttempts &&
+			pipeliner.getFrameCount() < cdc_test::serverPipelinedRequests; ++attempt) {
+			server.runOnce(0);
+			pipeliner.poll(cdc_test::serverPollMilliseconds);
 		}
+
+		assert(pipeliner.getFrameCount() == cdc_test::serverPipelinedRequests);
+		assert(pipeliner.getLastFrame() == timepiece->getTimes());
 	}
 
-	if (choice == 1) displayPlanetaryCDCMenu();
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
+}
 
-	if (choice == 2) displayCelestialTimepiece(createOrreryTimepiece());
+static void testSharedClockState() {
+	GalacticTimepiece* timepiece =
+		createRandomGalacticTimepiece(cdc_test::indexOrreryCount, cdc_test::indexClockCount);
+	const std::string name = "/cdc-test-" + std::to_string(std::rand());
+	std::vector<std::string> times;
+	ClockSnapshot snapshot;
+	ClockSnapshot expected;
 
-	if (choice == 3) displayCelestialTimepiece(createGalacticTimepiece());
-}
\ No newline at end of file
+	std::cout << "\n\nTesting shared clock state..." << std::endl;
+	timepiece->setTickThreadCount(1);
+
+	{
+		ClockStatePublisher publisher(*timepiece, name);
+		ClockStateReader reader(name);
+
+		reader.readTimes(times);
+		assert(times == timepiece->getTimes());
+
+		for (int tick = 0; tick < cdc_test::serverTicks; ++tick) {
+			timepiece->tick();
+			reader.read(snapshot);
+			timepiece->snapshot(expected);
+			assert(snapshot.tick == expected.tick);
+			assert(snapshot.profileIds == expected.profileIds);
+			assert(snapshot.secondsOfDay == expected.secondsOfDay);
+		}
+
+		reader.readTimesMilitary(times);
+		assert(times == timepiece->getTimesMilitary());
+		timepiece->add("Extra - ", createOrreryTimepiece());
+		timepiece->tick();
+		reader.readTimes(times);
+		assert(times == timepiece->getTimes());
+		assert(reader.getTotalSize() == timepiece->getSize());
+		assert(publisher.getPublishCount() == cdc_test::serverTicks + 2);
+
+		const std::vector<std::string> expectedTimes = timepiece->getTimes();
+		const pid_t child = fork();
+
+		if (child == 0) {
+			ClockStateReader childReader(name);
+			std::vector<std::string> childTimes;
+
+			childReader.readTimes(childTimes);
+			_exit(childTimes == expectedTimes ? 0 : 1);
+		}
+
+		int status = -1;
+
+		assert(child > 0 && waitpid(child, &status, 0) == child);
+		assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+		// A new day length takes a new revision, so the clock's layout is republished with it
+		timepiece->getTimepiece("Extra - ").getClockAt(0).setBodyMaximums(cdc_test::widenedBodyHours, 0);
+		timepiece->tick();
+		reader.readTimes(times);
+		assert(times == timepiece->getTimes());
+
+		// A publisher that stopped mid-write leaves the sequence odd, which readers give up on
+		const int fileDescriptor = shm_open(name.c_str(), O_RDWR, 0);
+		void* const mapping = mmap(nullptr, sizeof(SharedClockHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+		SharedClockHeader* const header = static_cast<SharedClockHeader*>(mapping);
+		bool isThrown = false;
+
+		assert(fileDescriptor >= 0 && mapping != MAP_FAILED);
+		close(fileDescriptor);
+		header->sequence.fetch_add(1);
+
+		try {
+			reader.read(snapshot);
+		}
+		catch (const std::runtime_error&) {
+			isThrown = true;
+		}
+
+		assert(isThrown);
+		header->sequence.fetch_add(1);
+		munmap(mapping, sizeof(SharedClockHeader));
+	}
+
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testShardedGalaxy() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createRandomGalacticTimepiece(cdc_test::shardOrreryCount, cdc_test::shardClockCount));
+	ShardedGalaxy shardedGalaxy(cdc_test::shardCount);
+	ClockSnapshot expected;
+	ClockSnapshot clockSnapshot;
+
+	std::cout << "\n\nTesting sharded galaxy..." << std::endl;
+	timepiece->setTickThreadCount(1);
+
+	// Every orrery starts on the first shard so that rebalancing has work to do
+	for (size_t index = 0; index < timepiece->getTimepieceCount(); ++index)
+		shardedGalaxy.add(std::string(timepiece->getLabelAt(index)), timepiece->getTimepieceAt(index), 0);
+
+	assert(shardedGalaxy.getShardCount() == cdc_test::shardCount);
+	assert(shardedGalaxy.getSize() == timepiece->getSize() && shardedGalaxy.getShardSize(0) == timepiece->getSize());
+	assert(shardedGalaxy.getTimes() == timepiece->getTimes());
+
+	for (int tick = 0; tick < cdc_test::shardTicks; ++tick) {
+		timepiece->tick();
+		shardedGalaxy.tick();
+	}
+
+	assert(shardedGalaxy.rebalance() > 0);
+
+	for (size_t shardIndex = 0; shardIndex < cdc_test::shardCount; ++shardIndex)
+		assert(shardedGalaxy.getShardSize(shardIndex) == timepiece->getSize() / cdc_test::shardCount);
+
+	for (int tick = 0; tick < cdc_test::shardTicks; ++tick) {
+		timepiece->tick();
+		shardedGalaxy.tick();
+	}
+
+	timepiece->snapshot(expected);
+	shardedGalaxy.snapshot(clockSnapshot);
+	assert(clockSnapshot.tick == expected.tick);
+	assert(clockSnapshot.secondsOfDay == expected.secondsOfDay && clockSnapshot.profileIds == expected.profileIds);
+	assert(shardedGalaxy.getTimes() == timepiece->getTimes());
+	assert(shardedGalaxy.getTimesMilitary() == timepiece->getTimesMilitary());
+	assert(shardedGalaxy.rebalance() == 0);
+	assert(shardedGalaxy.getTickLatency().tickCount == 2 * cdc_test::shardTicks);
+	assert(shardedGalaxy.getTickLatency().maxNanoseconds >= shardedGalaxy.getTickLatency().lastNanoseconds);
+	assert(shardedGalaxy.getTickLatency().getMeanNanoseconds() > 0.0);
+
+	// A shard dying mid-barrier stops the others rather than leaving their replies queued
+	bool threw = false;
+
+	kill(shardedGalaxy.getShardProcessId(1), SIGKILL);
+
+	try {
+		shardedGalaxy.tick();
+	}
+	catch (const std::runtime_error&) {
+		threw = true;
+	}
+
+	assert(threw && shardedGalaxy.isFailed() && shardedGalaxy.getShardCount() == 0);
+	threw = false;
+
+	try {
+		shardedGalaxy.getTimes();
+	}
+	catch (const std::runtime_error&) {
+		threw = true;
+	}
+
+	assert(threw && shardedGalaxy.getTickLatency().tickCount == 2 * cdc_test::shardTicks);
+	std::cout << cdc_test::passed << std::endl;
+}
+#endif
+
+static void testOffsetClockView() {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+	CelestialDayClock* base = new CelestialDayClock(earthDay.hours, earthDay.minutes);
+	std::vector<CelestialDayClock> references;
+	RenderedTimes times;
+
+	std::cout << "\n\nTesting offset clock views..." << std::endl;
+	base->setSecondsOfDay(std::rand() % base->getProfile().daySeconds);
+	orreryTimepiece->add("Base: ", base);
+	references.push_back(*base);
+
+	for (const int offset : cdc_test::viewOffsets) {
+		orreryTimepiece->add("Offset " + std::to_string(offset) + ": ", new OffsetClockView(*base, offset));
+		references.push_back(*base);
+		references.back().setSecondsOfDay(base->getSecondsOfDay() + offset);
+	}
+
+	assert(orreryTimepiece->getViewCount() == std::size(cdc_test::viewOffsets));
+
+	// A view of a clock the orrery does not own could outlive its base
+	CelestialDayClock outsider(earthDay.hours, earthDay.minutes);
+	std::unique_ptr<OffsetClockView> outsiderView(new OffsetClockView(outsider, cdc_test::viewOffsets[0]));
+	bool isThrown = false;
+
+	try {
+		orreryTimepiece->add("Outsider: ", outsiderView.get());
+	}
+	catch (const std::invalid_argument&) {
+		isThrown = true;
+	}
+
+	assert(isThrown && orreryTimepiece->getViewCount() == std::size(cdc_test::viewOffsets));
+	timepiece->add("Earth - ", orreryTimepiece);
+	timepiece->setTickThreadCount(1);
+
+	for (int tick = 1; tick <= cdc_test::viewTicks; ++tick) {
+		timepiece->tick();
+
+		for (CelestialDayClock& reference : references) reference.tick();
+
+		if (tick % cdc_test::viewCheckInterval != 0 && tick != cdc_test::viewTicks) continue;
+
+		const std::vector<std::string> militaryTimes = timepiece->getTimesMilitary();
+
+		timepiece->renderTimes(times);
+		assert(std::equal(times.begin(), times.end(), timepiece->getTimes().begin()));
+
+		for (size_t index = 0; index < references.size(); ++index) {
+			assert(times[index].ends_with(references[index].getTime()));
+			assert(militaryTimes[index].ends_with(references[index].getTimeMilitary()));
+		}
+	}
+
+	// Views follow their base onto a new day length with their offsets at the same phase
+	base->setBodyMaximums(cdc_test::widenedBodyHours, 0);
+
+	const std::vector<std::string> widenedTimes = timepiece->getTimes();
+	const int earthDaySeconds = references[0].getProfile().daySeconds;
+
+	for (size_t index = 1; index < references.size(); ++index) {
+		const CelestialDayClock& view = orreryTimepiece->getClockAt(index);
+		const int offset = DayPhase::toSecondsOfDay(DayPhase::fromSecondsOfDay(
+			(cdc_test::viewOffsets[index - 1] % earthDaySeconds + earthDaySeconds) % earthDaySeconds,
+			references[0].getProfile()), base->getProfile());
+
+		references[index] = *base;
+		references[index].setSecondsOfDay(base->getSecondsOfDay() + offset);
+		assert(view.getProfileId() == base->getProfileId());
+		assert(widenedTimes[index].ends_with(references[index].getTime()));
+	}
+
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testClockSlabs() {
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+	OrreryTimepiece firstTimepiece;
+	OrreryTimepiece secondTimepiece;
+	std::vector<CelestialDayClock> references;
+
+	std::cout << "\n\nTesting cache-line-aligned clock slabs..." << std::endl;
+	static_assert(sizeof(PaddedAtomic<bool>) == cacheLineSize);
+	static_assert(alignof(OrreryTimepiece) == cacheLineSize);
+
+	for (int index = 0; index < cdc_test::slabTestClocks; ++index) {
+		const std::string label = std::to_string(index) + ". ";
+		CelestialDayClock* const first = firstTimepiece.emplace(label, marsDay.hours, marsDay.minutes);
+		CelestialDayClock* const second = secondTimepiece.emplace(label, marsDay.hours, marsDay.minutes);
+		const std::uintptr_t firstAddress = reinterpret_cast<std::uintptr_t>(first);
+		const std::uintptr_t secondAddress = reinterpret_cast<std::uintptr_t>(second);
+
+		assert(first != nullptr && second != nullptr);
+		assert(firstAddress / cacheLineSize != secondAddress / cacheLineSize);
+		assert((firstAddress + sizeof(CelestialDayClock) - 1) / cacheLineSize !=
+			(secondAddress + sizeof(CelestialDayClock) - 1) / cacheLineSize);
+
+		if (index % OrreryTimepiece::slabClockCount == 0) assert(firstAddress % cacheLineSize == 0);
+
+		first->setSecondsOfDay(std::rand() % first->getProfile().daySeconds);
+		references.push_back(*first);
+	}
+
+	assert(firstTimepiece.emplace("0. ", marsDay.hours, marsDay.minutes) == nullptr);
+	firstTimepiece.add("Heap: ", new CelestialDayClock(marsDay.hours, marsDay.minutes));
+	references.emplace_back(marsDay.hours, marsDay.minutes);
+
+	for (int tick = 0; tick < cdc_test::viewCheckInterval; ++tick) {
+		firstTimepiece.tick();
+
+		for (CelestialDayClock& reference : references) reference.tick();
+	}
+
+	for (size_t index = 0; index < references.size(); ++index)
+		assert(firstTimepiece.getClockAt(index).getTime() == references[index].getTime());
+
+	firstTimepiece.clear();
+	assert(firstTimepiece.getSize() == 0);
+	assert(firstTimepiece.emplace("0. ", marsDay.hours, marsDay.minutes) != nullptr);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testClockHarness() {
+	ClockHarness harness;
+	std::string failure;
+
+	std::cout << "\n\nTesting the clock harness..." << std::endl;
+	assert(harness.getEngineCount() == cdc_test::harnessEngines);
+
+	// Odd hours, minutes around twice halfMaxBodyMinutes and the day's edges
+	for (const int h : cdc_test::harnessBodyHours) {
+		for (const int m : cdc_test::harnessBodyMinutes) {
+			const int daySeconds = CelestialDayClock(h, m).getProfile().daySeconds;
+
+			for (const int start : { 0, daySeconds / 2 - 1, daySeconds / 2, daySeconds - 1 }) {
+				assert(harness.check({ h, m, start, cdc_test::harnessEdgeTicks }, failure));
+			}
+		}
+	}
+
+	assert(harness.checkRandom(cdc_test::harnessCases, failure) == cdc_test::harnessCases);
+	assert(harness.check(ClockCase::fromBytes(nullptr, 0), failure));
+	harness.add("skipping", [](const CelestialDayClock& start, std::uint64_t ticks) {
+		CelestialDayClock clock = start;
+
+		for (std::uint64_t tick = 0; tick < ticks + 1; ++tick) clock.tick();
+
+		return clock;
+		});
+	assert(!harness.check({ 24, 0, 0, 1 }, failure) && failure.find("skipping") != std::string::npos);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testTracer() {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const std::unique_ptr<GalacticTimepiece> timepiece(new GalacticTimepiece());
+	std::ostringstream trace;
+
+	std::cout << "\n\nTesting the tracer..." << std::endl;
+
+	for (int orreryIndex = 0; orreryIndex < 2; ++orreryIndex) {
+		OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+
+		for (int clockIndex = 0; clockIndex < cdc_test::traceClockCount; ++clockIndex)
+			orreryTimepiece->emplace(std::to_string(clockIndex) + ". ", earthDay.hours, earthDay.minutes);
+
+		timepiece->add(std::to_string(orreryIndex) + ". ", orreryTimepiece);
+	}
+
+	Tracer::clear();
+	{
+		const TraceScope untraced("untraced");
+	}
+	assert(Tracer::getEventCount() == 0);
+	Tracer::start();
+	{
+		const TraceScope outer("outer");
+		const TraceScope inner("inner \"quoted\"");
+
+		timepiece->setTickThreadCount(2);
+		timepiece->tick();
+		timepiece->getTimes();
+	}
+	Tracer::stop();
+
+	const std::vector<TraceTotal> totals = Tracer::summarize();
+	const auto findTotal = [&totals](std::string_view name) {
+		return std::find_if(totals.begin(), totals.end(), [name](const TraceTotal& total) { return total.name == name; });
+		};
+
+	assert(findTotal("outer") != totals.end() && findTotal("outer")->count == 1);
+	assert(findTotal("inner \"quoted\"") != totals.end());
+	assert(findTotal("untraced") == totals.end());
+#ifdef CDC_TRACE
+	assert(findTotal("CelestialDayClock::tick")->count == timepiece->getSize());
+	assert(findTotal("GalacticTimepiece::tick half")->count == 2);
+#endif
+	Tracer::writeChromeTrace(trace);
+	assert(trace.str().starts_with("{\"traceEvents\":["));
+	assert(trace.str().find("\"name\":\"inner \\\"quoted\\\"\",\"cat\":\"cdc\",\"ph\":\"X\"") != std::string::npos);
+	assert(Tracer::getDroppedEventCount() == 0);
+	Tracer::clear();
+	assert(Tracer::getEventCount() == 0 && Tracer::summarize().empty());
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testMemoryUsage() {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const std::string orreryLabel = "Star System A: ";
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+	CelestialDayClock* base = new CelestialDayClock(earthDay.hours, earthDay.minutes);
+	size_t labelBytes = 0;
+
+	// A timepiece that implements only what it must is counted as its base object
+	struct MinimalTimepiece : CelestialTimepiece {
+		std::vector<std::string> getTimes() override { return {}; }
+
+		void compileTickPlan(TickPlan&) override {}
+
+		void tick() override {}
+	} minimalTimepiece;
+
+	std::cout << "\n\nTesting memory usage..." << std::endl;
+	assert(base->memoryUsage().getTotalBytes() == sizeof(CelestialDayClock));
+	assert(minimalTimepiece.memoryUsage().getTotalBytes() == sizeof(CelestialTimepiece));
+
+	for (size_t bytes = 1; bytes <= cdc_test::memoryAllocationBytes; ++bytes) {
+		const size_t overhead = MemoryUsage::estimateAllocationOverhead(bytes);
+
+		assert(overhead >= sizeof(size_t) && (bytes + overhead) % (2 * sizeof(size_t)) == 0);
+	}
+
+	orreryTimepiece->add("Base: ", base);
+	labelBytes += std::string("Base: ").size();
+
+	for (int clockIndex = 0; clockIndex < cdc_test::memoryClocks; ++clockIndex) {
+		const std::string label = std::to_string(clockIndex) + ". ";
+
+		if (clockIndex % 2 == 0) orreryTimepiece->add(label, new CelestialDayClock(earthDay.hours, earthDay.minutes));
+		else orreryTimepiece->emplace(label, earthDay.hours, earthDay.minutes);
+
+		labelBytes += label.size();
+	}
+
+	orreryTimepiece->add("View: ", new OffsetClockView(*base, cdc_test::viewOffsets[0]));
+	labelBytes += std::string("View: ").size();
+
+	const MemoryUsage orreryUsage = orreryTimepiece->memoryUsage();
+
+	assert(orreryUsage.stateBytes ==
+		sizeof(OrreryTimepiece) + (cdc_test::memoryClocks + 1) * sizeof(CelestialDayClock) + sizeof(OffsetClockView));
+	assert(orreryUsage.labelBytes == labelBytes);
+	assert(orreryUsage.containerBytes >= (OrreryTimepiece::slabClockCount - cdc_test::memoryClocks / 2) *
+		sizeof(CelestialDayClock) + orreryTimepiece->getSize() * sizeof(void*));
+	assert(orreryUsage.allocatorOverheadBytes > 0);
+	timepiece->add(orreryLabel, orreryTimepiece);
+
+	const MemoryUsage usage = timepiece->memoryUsage();
+
+	assert(usage.stateBytes == sizeof(GalacticTimepiece) + orreryUsage.stateBytes);
+	assert(usage.labelBytes == orreryLabel.size() + orreryUsage.labelBytes);
+	assert(usage.allocatorOverheadBytes > orreryUsage.allocatorOverheadBytes);
+	assert(usage.getTotalBytes() > orreryUsage.getTotalBytes());
+	timepiece->clear();
+	assert(timepiece->memoryUsage().labelBytes == 0);
+	delete timepiece;
+
+	// A full slab replaces one allocation per clock
+	const int slabClockCount = static_cast<int>(OrreryTimepiece::slabClockCount);
+	const std::unique_ptr<GalacticTimepiece> heapTimepiece(createBenchGalacticTimepiece(false, slabClockCount));
+	const std::unique_ptr<GalacticTimepiece> packedTimepiece(createBenchGalacticTimepiece(true, slabClockCount));
+
+	assert(heapTimepiece->getSize() == packedTimepiece->getSize());
+	assert(heapTimepiece->memoryUsage().allocatorOverheadBytes > packedTimepiece->memoryUsage().allocatorOverheadBytes);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testTickPlan() {
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	std::vector<OrreryTimepiece*> orreryTimepieces;
+	std::vector<CelestialDayClock*> clocks;
+	std::vector<CelestialDayClock> references;
+	CelestialDayClock leafClock(marsDay.hours, marsDay.minutes);
+	OffsetClockView view(leafClock, cdc_test::viewOffsets[0]);
+	TickPlan plan;
+
+	std::cout << "\n\nTesting tick plans..." << std::endl;
+	plan.compile(leafClock);
+	assert(plan.getSize() == 1 && plan.getCounterCount() == 0 && plan.isCurrent(leafClock));
+	plan.compile(view);
+	assert(plan.getSize() == 0 && plan.getSplit() == 0);
+
+	// A timepiece that cannot list clocks for a plan refuses to be compiled into one
+	struct UnplannedTimepiece : CelestialTimepiece {
+		std::vector<std::string> getTimes() override { return {}; }
+
+		void tick() override {}
+	} unplannedTimepiece;
+	bool isThrown = false;
+
+	try {
+		plan.compile(unplannedTimepiece);
+	}
+	catch (const std::runtime_error&) {
+		isThrown = true;
+	}
+
+	assert(isThrown && !plan.isCurrent(unplannedTimepiece));
+
+	for (const int orreryClockCount : cdc_test::planOrreryClockCounts) {
+		OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+
+		for (int clockIndex = 0; clockIndex < orreryClockCount; ++clockIndex) {
+			const std::string label = std::to_string(clockIndex) + ". ";
+			CelestialDayClock* clock = clockIndex % 2 == 0 ? orreryTimepiece->emplace(label, marsDay.hours, marsDay.minutes) :
+				new CelestialDayClock(marsDay.hours, marsDay.minutes);
+
+			clock->setSecondsOfDay(std::rand() % clock->getProfile().daySeconds);
+
+			if (clockIndex % 2 != 0) orreryTimepiece->add(label, clock);
+
+			clocks.push_back(clock);
+			references.push_back(*clock);
+		}
+
+		if (orreryClockCount > 0) orreryTimepiece->add("View: ", new OffsetClockView(*clocks.back(), cdc_test::viewOffsets[1]));
+
+		orreryTimepieces.push_back(orreryTimepiece);
+		timepiece->add(std::to_string(orreryTimepieces.size()) + ". ", orreryTimepiece);
+	}
+
+	for (const size_t threadCount : { 1, 2 }) {
+		timepiece->setTickThreadCount(threadCount);
+
+		for (int tick = 0; tick < cdc_test::planTicks; ++tick) {
+			timepiece->tick();
+
+			for (CelestialDayClock& reference : references) reference.tick();
+		}
+	}
+
+	const TickPlan& galaxyPlan = timepiece->getTickPlan();
+	const size_t split = galaxyPlan.getSplit();
+	size_t boundary = 0;
+
+	assert(galaxyPlan.getCompileCount() == 1 && galaxyPlan.getSize() == clocks.size());
+	assert(galaxyPlan.getCounterCount() == orreryTimepieces.size());
+
+	for (size_t index = 0; index < clocks.size(); ++index) assert(clocks[index]->getTime() == references[index].getTime());
+
+	for (size_t orreryIndex = 0; orreryIndex < orreryTimepieces.size() && boundary < split; ++orreryIndex) {
+		boundary += orreryTimepieces[orreryIndex]->getSize() - orreryTimepieces[orreryIndex]->getViewCount();
+		assert(orreryTimepieces[orreryIndex]->getTickCount() == 2 * cdc_test::planTicks);
+	}
+
+	assert(boundary == split);
+	orreryTimepieces.front()->emplace("New: ", marsDay.hours, marsDay.minutes);
+	timepiece->tick();
+	assert(galaxyPlan.getCompileCount() == 2 && galaxyPlan.getSize() == clocks.size() + 1);
+	timepiece->add("Empty: ", new OrreryTimepiece());
+	timepiece->tick();
+	assert(galaxyPlan.getCompileCount() == 3 && galaxyPlan.getCounterCount() == orreryTimepieces.size() + 1);
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testStaticTimepiece() {
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	StaticTimepieceAdapter<StaticGalaxy> adapter;
+	CelestialTimepiece* const adaptedTimepiece = &adapter;
+	StaticGalaxy& staticGalaxy = adapter.get();
+	TickPlan plan;
+
+	std::cout << "\n\nTesting static timepieces..." << std::endl;
+
+	for (int orreryIndex = 0; orreryIndex < cdc_test::staticOrreryCount; ++orreryIndex) {
+		const std::string orreryLabel = "System " + std::to_string(orreryIndex) + ": ";
+		OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+		StaticOrrery* const staticOrrery = staticGalaxy.add(orreryLabel);
+
+		assert(staticOrrery != nullptr && staticGalaxy.add(orreryLabel) == nullptr);
+
+		for (const auto& [planetChoice, celestialDay] : planetDayLengths) {
+			const std::string label = planetNames.at(planetChoice) + ": ";
+			CelestialDayClock* clock = new CelestialDayClock(celestialDay.hours, celestialDay.minutes);
+
+			clock->setSecondsOfDay(std::rand() % clock->getProfile().daySeconds);
+			orreryTimepiece->add(label, clock);
+			assert(staticOrrery->add(label, *clock) != nullptr);
+		}
+
+		timepiece->add(orreryLabel, orreryTimepiece);
+	}
+
+	assert(adaptedTimepiece->getTimes() == timepiece->getTimes());
+	assert(staticGalaxy.getSize() == timepiece->getSize());
+	assert(adaptedTimepiece->memoryUsage().labelBytes == timepiece->memoryUsage().labelBytes);
+	timepiece->setTickThreadCount(1);
+
+	for (int tick = 0; tick < cdc_test::staticTicks; ++tick) {
+		timepiece->tick();
+
+		if (tick % 2 == 0) staticGalaxy.tick();
+		else adaptedTimepiece->tick();
+	}
+
+	assert(staticGalaxy.getTimes() == timepiece->getTimes());
+	assert(staticGalaxy.getTimesMilitary() == timepiece->getTimesMilitary());
+	plan.compile(*adaptedTimepiece);
+	assert(plan.getSize() == staticGalaxy.getSize() && plan.isCurrent(*adaptedTimepiece));
+	plan.tick();
+	timepiece->tick();
+	assert(staticGalaxy.getTimes() == timepiece->getTimes());
+	staticGalaxy.getChildAt(0).add("Extra: ", cdc_test::hours, 0);
+	assert(!plan.isCurrent(*adaptedTimepiece));
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testEpochDayClock() {
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+	CelestialDayClock reference(marsDay.hours, marsDay.minutes);
+	EpochDayClock clock(marsDay.hours, marsDay.minutes, cdc_test::epochTime, 5);
+	const std::time_t daySeconds = clock.getProfile().daySeconds;
+	std::time_t now = cdc_test::epochTime;
+
+	std::cout << "\n\nTesting epoch-anchored clocks..." << std::endl;
+	clock.syncAt(cdc_test::epochTime);
+	assert(clock.getSecondsOfDay() == 5);
+	clock.syncAt(cdc_test::epochTime + daySeconds * cdc_test::epochDays);
+	assert(clock.getSecondsOfDay() == 5);
+	clock.syncAt(cdc_test::epochTime - 6);
+	assert(clock.getSecondsOfDay() == daySeconds - 1);
+	reference.setSecondsOfDay(std::rand() % daySeconds);
+
+	const EpochDayClock anchoredClock(reference, now);
+
+	assert(anchoredClock.getTime() == reference.getTime());
+	clock = anchoredClock;
+
+	for (int step = 0; step < cdc_test::epochSteps; ++step) {
+		const int ticks = std::rand() % cdc_test::viewCheckInterval;
+
+		for (int tick = 0; tick < ticks; ++tick) reference.tick();
+
+		now += ticks;
+		clock.syncAt(now);
+		assert(clock.getTimeMilitary() == reference.getTimeMilitary() && clock.getTime() == reference.getTime());
+	}
+
+	// A galaxy of epoch clocks reads the wall clock without ever being ticked
+	for (const auto& [planetChoice, celestialDay] : planetDayLengths) {
+		orreryTimepiece->add(planetNames.at(planetChoice) + ": ",
+			new EpochDayClock(celestialDay.hours, celestialDay.minutes, std::time(nullptr), cdc_test::epochStartSeconds));
+	}
+
+	// An epoch clock handed over as a plain clock is still synced rather than ticked
+	CelestialDayClock* const epochClock = new EpochDayClock(marsDay.hours, marsDay.minutes, std::time(nullptr), cdc_test::epochStartSeconds);
+
+	orreryTimepiece->add("Mars again: ", epochClock);
+	timepiece->add("Epoch: ", orreryTimepiece);
+	timepiece->tick();
+	assert(timepiece->getTickPlan().getSize() == 0 && orreryTimepiece->getViewCount() == planetDayLengths.size() + 1);
+	timepiece->getTimes();
+
+	for (size_t index = 0; index < orreryTimepiece->getSize(); ++index) {
+		const int elapsed = orreryTimepiece->getClockAt(index).getSecondsOfDay() - cdc_test::epochStartSeconds;
+
+		assert(elapsed >= 0 && elapsed <= cdc_test::epochToleranceSeconds);
+	}
+
+	assert(orreryTimepiece->memoryUsage().stateBytes ==
+		sizeof(OrreryTimepiece) + (planetDayLengths.size() + 1) * sizeof(EpochDayClock));
+	delete timepiece;
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testRewind() {
+	std::cout << "\n\nTesting rewinding clocks..." << std::endl;
+
+	for (const auto& [planetChoice, celestialDay] : planetDayLengths) {
+		CelestialDayClock clock(celestialDay.hours, celestialDay.minutes);
+		const int daySeconds = clock.getProfile().daySeconds;
+		const int halfDaySeconds = clock.getProfile().halfDaySeconds;
+
+		// Rewinding across each reset and then ticking forward again must land on the same time
+		for (const int start : { 0, halfDaySeconds, halfDaySeconds + 1, daySeconds - 1, std::rand() % daySeconds }) {
+			for (const std::uint64_t seconds : { std::uint64_t(1), std::uint64_t(2),
+				std::uint64_t(std::rand() % cdc_test::viewCheckInterval), std::uint64_t(daySeconds) * cdc_test::epochDays + 1 }) {
+				CelestialDayClock rewound = clock;
+
+				clock.setSecondsOfDay(start);
+				rewound.setSecondsOfDay(start);
+				rewound.rewind(seconds);
+
+				for (std::uint64_t tick = 0; tick < seconds % daySeconds; ++tick) rewound.tick();
+
+				assert(rewound.getTimeMilitary() == clock.getTimeMilitary() && rewound.getTime() == clock.getTime());
+			}
+		}
+
+		clock.setSecondsOfDay(0);
+		clock.rewind(1);
+		assert(clock.getSecondsOfDay() == daySeconds - 1);
+	}
+
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testClockHistory() {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+	const std::unique_ptr<GalacticTimepiece> timepiece(createRandomGalacticTimepiece(2, cdc_test::historyClockCount));
+	std::map<std::uint64_t, ClockSnapshot> expected;
+	ClockSnapshot clockSnapshot;
+
+	std::cout << "\n\nTesting clock history..." << std::endl;
+	timepiece->setTickThreadCount(1);
+
+	OrreryTimepiece& orreryTimepiece = timepiece->getTimepiece(std::string(timepiece->getLabelAt(0)));
+	ClockHistory history(*timepiece, cdc_test::historyCapacity);
+
+	orreryTimepiece.add("View: ", new OffsetClockView(orreryTimepiece.getClockAt(0), cdc_test::viewOffsets[2]));
+
+	for (int tick = 0; tick < cdc_test::historyTicks; ++tick) {
+		// Setting times, adding clocks and changing day lengths are recorded as deltas and keyframes
+		if (tick % cdc_test::historySetInterval == 0)
+			orreryTimepiece.getClockAt(1).setSecondsOfDay(std::rand() % orreryTimepiece.getClockAt(1).getProfile().daySeconds);
+
+		if (tick == cdc_test::historyTicks / 2) orreryTimepiece.add("Added: ", new CelestialDayClock(marsDay.hours, marsDay.minutes));
+
+		if (tick == cdc_test::historyTicks * 3 / 4) orreryTimepiece.getClockAt(2).setBodyMaximums(earthDay.hours, earthDay.minutes);
+
+		timepiece->tick();
+		timepiece->snapshot(expected[timepiece->getTickCount()]);
+	}
+
+	assert(history.getSize() == cdc_test::historyCapacity);
+	assert(history.getNewestTick() == timepiece->getTickCount());
+	assert(history.getOldestTick() == timepiece->getTickCount() - cdc_test::historyCapacity + 1);
+	assert(history.getKeyframeCount() < cdc_test::historyCapacity / 8);
+	assert(history.getDeltaCount() < cdc_test::historyCapacity);
+	assert(!history.at(history.getOldestTick() - 1, clockSnapshot) && !history.at(history.getNewestTick() + 1, clockSnapshot));
+
+	for (std::uint64_t tick = history.getOldestTick(); tick <= history.getNewestTick(); ++tick) {
+		assert(history.at(tick, clockSnapshot));
+		assert(clockSnapshot.secondsOfDay == expected[tick].secondsOfDay && clockSnapshot.profileIds == expected[tick].profileIds);
+	}
+
+	std::vector<std::string> times;
+
+	assert(history.ago(0, clockSnapshot) && clockSnapshot.tick == timepiece->getTickCount());
+	assert(history.getTimes(history.getNewestTick(), times) && times == timepiece->getTimes());
+	assert(history.getTimesMilitary(history.getNewestTick(), times) && times == timepiece->getTimesMilitary());
+	assert(history.memoryUsage().getTotalBytes() > 0);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testColumnarLog() {
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+	const std::unique_ptr<GalacticTimepiece> timepiece(createRandomGalacticTimepiece(3, cdc_test::columnarLogClockCount));
+	std::map<std::uint64_t, ClockSnapshot> expected;
+	std::stringstream log;
+	std::stringstream sampledLog;
+	size_t textBytes = 0;
+
+	std::cout << "\n\nTesting columnar log..." << std::endl;
+	timepiece->setTickThreadCount(1);
+
+	OrreryTimepiece& orreryTimepiece = timepiece->getTimepiece(std::string(timepiece->getLabelAt(0)));
+
+	{
+		ColumnarLogWriter writer(*timepiece, log, 1, cdc_test::columnarLogBlockSamples);
+		ColumnarLogWriter sampledWriter(*timepiece, sampledLog, cdc_test::columnarLogInterval);
+
+		for (int tick = 0; tick < cdc_test::columnarLogTicks; ++tick) {
+			// Set times break runs and added clocks start a new dictionary
+			if (tick % cdc_test::historySetInterval == 0)
+				orreryTimepiece.getClockAt(1).setSecondsOfDay(std::rand() % orreryTimepiece.getClockAt(1).getProfile().daySeconds);
+
+			if (tick == cdc_test::columnarLogTicks / 2) orreryTimepiece.add("Added, \"quoted\": ", new CelestialDayClock(marsDay.hours, marsDay.minutes));
+
+			timepiece->tick();
+			timepiece->snapshot(expected[timepiece->getTickCount()]);
+
+			for (const std::string& time : timepiece->getTimes()) textBytes += time.size() + 1;
+		}
+
+		writer.flush();
+		assert(writer.getSampleCount() == static_cast<std::uint64_t>(cdc_test::columnarLogTicks));
+		assert(writer.getBlockCount() > static_cast<std::uint64_t>(cdc_test::columnarLogTicks) / cdc_test::columnarLogBlockSamples);
+		assert(sampledWriter.getSampleCount() == cdc_test::columnarLogTicks / cdc_test::columnarLogInterval);
+	}
+
+	assert(log.str().size() * cdc_test::columnarLogMinRatio <= textBytes);
+
+	ColumnarLogReader reader(log);
+	ColumnarLogReader sampledReader(sampledLog);
+	ClockSnapshot clockSnapshot;
+	std::uint64_t sampleCount = 0;
+
+	while (reader.next(clockSnapshot)) {
+		const ClockSnapshot& expectedSnapshot = expected.at(clockSnapshot.tick);
+
+		assert(clockSnapshot.secondsOfDay == expectedSnapshot.secondsOfDay && clockSnapshot.profileIds == expectedSnapshot.profileIds);
+		++sampleCount;
+	}
+
+	assert(sampleCount == static_cast<std::uint64_t>(cdc_test::columnarLogTicks));
+	assert(reader.getLabels().size() == timepiece->getSize());
+	sampleCount = 0;
+
+	while (sampledReader.next(clockSnapshot)) {
+		assert(clockSnapshot.tick % cdc_test::columnarLogInterval == 0);
+		assert(clockSnapshot.secondsOfDay == expected.at(clockSnapshot.tick).secondsOfDay);
+		++sampleCount;
+	}
+
+	assert(sampleCount == cdc_test::columnarLogTicks / cdc_test::columnarLogInterval);
+
+	std::stringstream csv;
+	std::string line;
+
+	log.clear();
+	log.seekg(0);
+	assert(ColumnarLogReader::exportCsv(log, csv) == expected.begin()->second.getSize() * (cdc_test::columnarLogTicks / 2) +
+		expected.rbegin()->second.getSize() * (cdc_test::columnarLogTicks / 2));
+	assert(std::getline(csv, line) && line == "tick,label,seconds_of_day,time");
+	assert(std::getline(csv, line) && line.rfind("1,", 0) == 0);
+
+	// Corrupt counts and lengths fail as corrupt or truncated logs rather than as huge allocations
+	const auto readCorruptLog = [](std::initializer_list<int> bytes) {
+		std::string data(ColumnarLogWriter::magic, sizeof(ColumnarLogWriter::magic));
+		ClockSnapshot corruptSnapshot;
+
+		data.push_back(static_cast<char>(ColumnarLogWriter::version));
+
+		for (const int byte : bytes) data.push_back(static_cast<char>(byte));
+
+		std::istringstream corruptLog(data);
+
+		try {
+			ColumnarLogReader corruptReader(corruptLog);
+
+			while (corruptReader.next(corruptSnapshot)) {}
+		}
+		catch (const std::runtime_error& e) {
+			return std::string(e.what());
+		}
+
+		return std::string();
+		};
+
+	assert(readCorruptLog({ 1, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F }) == "Corrupt profile count in columnar log");
+	assert(readCorruptLog({ 1, 0, 1, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 'a' }) == "Truncated columnar log");
+	assert(readCorruptLog({ 1, 1, 48, 0, 1, 1, 'a', 0, 2, 0, 1, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F }) ==
+		"Corrupt sample count in columnar log");
+
+	// A wide block of the most samples costs memory for its runs only, not for every sample it claims
+	std::string wideData(ColumnarLogWriter::magic, sizeof(ColumnarLogWriter::magic));
+	ClockSnapshot wideSnapshot;
+
+	wideData += { static_cast<char>(ColumnarLogWriter::version), 1, 1, 48, 0 };
+
+	for (size_t value = cdc_test::columnarLogWideClocks; value > 0; value >>= 7)
+		wideData.push_back(static_cast<char>((value & 0x7F) | (value > 0x7F ? 0x80 : 0)));
+
+	for (size_t index = 0; index < cdc_test::columnarLogWideClocks; ++index) wideData += { 0, 0 };
+
+	wideData += { 2, 0, 1, '\x80', '\x80', 4 };
+
+	for (size_t index = 0; index < cdc_test::columnarLogWideClocks; ++index) wideData += { 0, '\xFF', '\xFF', 3, 0 };
+
+	std::istringstream wideLog(wideData);
+	ColumnarLogReader wideReader(wideLog);
+
+	assert(wideReader.next(wideSnapshot) && wideReader.next(wideSnapshot));
+	assert(wideSnapshot.tick == 1 && wideSnapshot.getSize() == cdc_test::columnarLogWideClocks);
+	assert(std::all_of(wideSnapshot.secondsOfDay.begin(), wideSnapshot.secondsOfDay.end(),
+		[](int secondsOfDay) { return secondsOfDay == 1; }));
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testClockLoader() {
+	GalacticTimepiece expected;
+	std::vector<OrreryTimepiece*> orreries;
+	std::ostringstream text;
+
+	std::cout << "\n\nTesting clock loader..." << std::endl;
+	text << "# orrery,clock,hours,minutes,seconds of day\r\n\n";
+
+	for (int orreryIndex = 0; orreryIndex < cdc_test::loaderOrreryCount; ++orreryIndex) {
+		orreries.push_back(new OrreryTimepiece());
+		expected.add("Star System " + std::to_string(orreryIndex) + " - ", orreries.back());
+	}
+
+	// Orreries are interleaved so that the loader has to group their clocks
+	for (int clockIndex = 0; clockIndex < cdc_test::loaderClockCount; ++clockIndex) {
+		const CelestialDay& day = planetDayLengths.at(static_cast<PlanetChoice>(clockIndex % PlanetChoice::MaxChoice + 1));
+
+		for (int orreryIndex = 0; orreryIndex < cdc_test::loaderOrreryCount; ++orreryIndex) {
+			const int secondsOfDay = clockIndex == 0 ? 0 : std::rand();
+			const std::string label = std::to_string(clockIndex) + ". ";
+
+			orreries[orreryIndex]->emplace(label, day.hours, day.minutes)->setSecondsOfDay(secondsOfDay);
+			text << "Star System " << orreryIndex << " - ," << label << ',' << day.hours << ',' << day.minutes;
+
+			if (clockIndex > 0) text << ',' << secondsOfDay;
+
+			text << (orreryIndex % 2 == 0 ? "\n" : "\r\n");
+		}
+	}
+
+	const std::string definitions = text.str();
+	const std::unique_ptr<GalacticTimepiece> timepiece(ClockLoader::load(definitions, cdc_test::loaderThreadCount));
+
+	assert(timepiece->getTimepieceCount() == expected.getTimepieceCount());
+	assert(timepiece->getSize() == expected.getSize());
+	assert(timepiece->getTimes() == expected.getTimes());
+
+	std::ofstream out(cdc_test::loaderFileName, std::ios::binary);
+
+	out << definitions;
+	out.close();
+
+	const std::unique_ptr<GalacticTimepiece> fileTimepiece(ClockLoader::loadFile(cdc_test::loaderFileName));
+
+	std::remove(cdc_test::loaderFileName);
+	fileTimepiece->tick();
+	expected.tick();
+	assert(fileTimepiece->getTimesMilitary() == expected.getTimesMilitary());
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testRenderCache() {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const std::unique_ptr<GalacticTimepiece> timepiece(createBenchGalacticTimepiece(true, cdc_test::renderCacheClockCount));
+	const std::unique_ptr<GalacticTimepiece> randomTimepiece(
+		createRandomGalacticTimepiece(cdc_test::renderCacheOrreryCount, cdc_test::renderCacheClockCount));
+	RenderCache cache;
+	CelestialDayClock clock(earthDay.hours, earthDay.minutes);
+	CelestialDayClock twin(earthDay.hours, earthDay.minutes);
+	RenderedTimes times;
+	RenderedTimes uncachedTimes;
+	char time[CelestialDayClock::maxTimeLength];
+	char expected[CelestialDayClock::maxTimeLength];
+
+	std::cout << "\n\nTesting render cache..." << std::endl;
+	clock.setSecondsOfDay(earthDay.hours * DayProfile::secondsPerHour / 2 + 1);
+	twin.setSecondsOfDay(clock.getSecondsOfDay());
+	assert(cache.formatTime(clock, time) == clock.formatTime(expected) && std::memcmp(time, expected, clock.formatTime(expected)) == 0);
+	assert(cache.formatTime(twin, time) == twin.formatTime(expected) && cache.getHitCount() == 1 && cache.getMissCount() == 1);
+	assert(cache.formatTimeMilitary(twin, time) == twin.formatTimeMilitary(expected) && cache.getMissCount() == 2);
+	assert(std::string_view(time, twin.formatTimeMilitary(expected)) == twin.getTimeMilitary());
+	cache.resetCounters();
+	assert(cache.getHitRate() == 0.0);
+
+	// A synchronized fleet formats each time once per render
+	timepiece->renderTimes(times);
+	assert(timepiece->getRenderCacheMissCount() <= timepiece->getTimepieceCount());
+	assert(timepiece->getRenderCacheHitCount() + timepiece->getRenderCacheMissCount() == timepiece->getSize());
+	assert(std::vector<std::string>(times.begin(), times.end()) == timepiece->getTimes());
+
+	// getTimes keeps its caches between calls, so the fleet's times are already cached
+	OrreryTimepiece& orreryTimepiece = timepiece->getTimepiece(std::string(timepiece->getLabelAt(0)));
+	const size_t orreryBytes = orreryTimepiece.memoryUsage().getTotalBytes();
+	const std::vector<std::string> orreryTimes = orreryTimepiece.getTimes();
+	const size_t cachedOrreryBytes = orreryTimepiece.memoryUsage().getTotalBytes();
+
+	assert(timepiece->getRenderCacheMissCount() <= timepiece->getTimepieceCount());
+	assert(timepiece->getRenderCacheHitCount() + timepiece->getRenderCacheMissCount() == 2 * timepiece->getSize());
+	assert(cachedOrreryBytes > orreryBytes);
+	assert(orreryTimepiece.getTimes() == orreryTimes && orreryTimepiece.memoryUsage().getTotalBytes() == cachedOrreryBytes);
+
+	randomTimepiece->setTickThreadCount(1);
+
+	for (int tick = 0; tick < cdc_test::renderCacheTicks; ++tick) {
+		randomTimepiece->tick();
+		randomTimepiece->setRenderCaching(true);
+		randomTimepiece->renderTimes(times);
+		randomTimepiece->setRenderCaching(false);
+		randomTimepiece->renderTimes(uncachedTimes);
+		assert(times.getLines() == uncachedTimes.getLines());
+		randomTimepiece->setRenderCaching(true);
+		randomTimepiece->renderTimesMilitary(times);
+		assert(std::vector<std::string>(times.begin(), times.end()) == randomTimepiece->getTimesMilitary());
+	}
+
+	assert(cache.memoryUsage().containerBytes >= cache.getCapacity() * CelestialDayClock::maxTimeLength);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testClockRanking() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createRandomGalacticTimepiece(cdc_test::rankingOrreryCount, cdc_test::rankingClockCount));
+	ClockSnapshot clockSnapshot;
+
+	const auto rankByComparison = [](RankKey key, const ClockSnapshot& rankedSnapshot) {
+		std::vector<std::uint32_t> indices(rankedSnapshot.getSize());
+
+		for (size_t index = 0; index < indices.size(); ++index) indices[index] = static_cast<std::uint32_t>(index);
+
+		std::stable_sort(indices.begin(), indices.end(), [key, &rankedSnapshot](std::uint32_t first, std::uint32_t second) {
+			return ClockRanking::getKeyValue(key, rankedSnapshot.secondsOfDay[first], DayProfile::get(rankedSnapshot.profileIds[first])) <
+				ClockRanking::getKeyValue(key, rankedSnapshot.secondsOfDay[second], DayProfile::get(rankedSnapshot.profileIds[second]));
+			});
+
+		return indices;
+		};
+
+	std::cout << "\n\nTesting clock ranking..." << std::endl;
+	timepiece->setTickThreadCount(1);
+
+	for (const RankKey key : { RankKey::SecondsOfDay, RankKey::DayPhase, RankKey::MidnightDistance, RankKey::NoonDistance }) {
+		ClockRanking ranking(key);
+
+		timepiece->snapshot(clockSnapshot);
+		assert(ranking.rank(*timepiece) == rankByComparison(key, clockSnapshot));
+
+		// Ordering barely changes from one tick to the next, so most updates merge a few displaced clocks
+		for (int tick = 0; tick < cdc_test::rankingTicks; ++tick) {
+			timepiece->tick();
+			timepiece->snapshot(clockSnapshot);
+			assert(ranking.update(*timepiece) == rankByComparison(key, clockSnapshot));
+		}
+
+		assert(ranking.getFullSortCount() + ranking.getIncrementalCount() == cdc_test::rankingTicks + 1);
+		assert(ranking.getIncrementalCount() > static_cast<std::uint64_t>(cdc_test::rankingTicks) / 2);
+	}
+
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const CelestialDay& marsDay = planetDayLengths.at(PlanetChoice::Mars);
+	const DayProfile::Id profileIds[] = { DayProfile::fromBodyMaximums(earthDay.hours, earthDay.minutes),
+		DayProfile::fromBodyMaximums(marsDay.hours, marsDay.minutes) };
+	ClockRanking parallelRanking(RankKey::DayPhase, cdc_test::rankingThreadCount);
+
+	clockSnapshot.profileIds.clear();
+	clockSnapshot.secondsOfDay.clear();
+
+	for (size_t index = 0; index < cdc_test::rankingParallelClocks; ++index) {
+		const DayProfile::Id profileId = profileIds[index % 2];
+
+		clockSnapshot.profileIds.push_back(profileId);
+		clockSnapshot.secondsOfDay.push_back(std::rand() % DayProfile::get(profileId).daySeconds);
+	}
+
+	assert(parallelRanking.rank(clockSnapshot) == rankByComparison(RankKey::DayPhase, clockSnapshot));
+
+	for (size_t index = 0; index < clockSnapshot.getSize(); ++index)
+		clockSnapshot.secondsOfDay[index] = (clockSnapshot.secondsOfDay[index] + 1) % DayProfile::get(clockSnapshot.profileIds[index]).daySeconds;
+
+	assert(parallelRanking.update(clockSnapshot) == rankByComparison(RankKey::DayPhase, clockSnapshot));
+	assert(parallelRanking.getIncrementalCount() == 1);
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testReprofile() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createRandomGalacticTimepiece(cdc_test::reprofileOrreryCount, cdc_test::reprofileClockCount));
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const DayProfile::Id earthId = DayProfile::fromBodyMaximums(earthDay.hours, earthDay.minutes);
+	const DayProfile::Id revisedId = DayProfile::fromBodyMaximums(cdc_test::reprofileBodyHours, cdc_test::reprofileBodyMinutes);
+	const DayProfile& earthProfile = DayProfile::get(earthId);
+	const DayProfile& revisedProfile = DayProfile::get(revisedId);
+	OrreryTimepiece orreryTimepiece;
+	RenderedTimes times;
+	ClockSnapshot before;
+	ClockSnapshot after;
+
+	std::cout << "\n\nTesting bulk reprofiling..." << std::endl;
+
+	// Clocks that rolled over or sit in the last half of the day exercise every field of the new profile
+	for (int index = 0; index < cdc_test::reprofileClockCount; ++index) {
+		const CelestialDay& celestialDay = index % 3 == 0 ? planetDayLengths.at(PlanetChoice::Mars) : earthDay;
+		CelestialDayClock* const clock = orreryTimepiece.emplace(std::to_string(index), celestialDay.hours, celestialDay.minutes);
+
+		clock->setSecondsOfDay(index == 1 ? earthProfile.daySeconds - 1 : std::rand());
+	}
+
+	orreryTimepiece.snapshot(before);
+	assert(orreryTimepiece.reprofile(earthId, earthId) == 0);
+	assert(orreryTimepiece.reprofile(earthId, revisedId) == static_cast<size_t>(cdc_test::reprofileClockCount -
+		(cdc_test::reprofileClockCount + 2) / 3));
+	orreryTimepiece.snapshot(after);
+
+	for (size_t index = 0; index < before.getSize(); ++index) {
+		const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+		CelestialDayClock reference(cdc_test::reprofileBodyHours, cdc_test::reprofileBodyMinutes);
+
+		if (before.profileIds[index] != earthId) {
+			assert(after.profileIds[index] == before.profileIds[index] && after.secondsOfDay[index] == before.secondsOfDay[index]);
+			continue;
+		}
+
+		const std::uint32_t phase = DayPhase::fromSecondsOfDay(before.secondsOfDay[index], earthProfile);
+
+		reference.setSecondsOfDay(after.secondsOfDay[index]);
+		assert(after.profileIds[index] == revisedId);
+		assert(after.secondsOfDay[index] == DayPhase::toSecondsOfDay(phase, revisedProfile));
+		assert(clock.getTimeMilitary() == reference.getTimeMilitary() && clock.getTime() == reference.getTime());
+	}
+
+	// An epoch clock is re-anchored, so it keeps its phase at every later wall time too
+	EpochDayClock epochClock(earthDay.hours, earthDay.minutes, cdc_test::epochTime, cdc_test::reprofileEpochSeconds);
+	const int epochSecondsOfDay = DayPhase::toSecondsOfDay(
+		DayPhase::fromSecondsOfDay(cdc_test::reprofileEpochSeconds, earthProfile), revisedProfile);
+
+	epochClock.reprofileAt(revisedId, cdc_test::epochTime);
+	epochClock.syncAt(cdc_test::epochTime);
+	assert(epochClock.getProfileId() == revisedId && epochClock.getSecondsOfDay() == epochSecondsOfDay);
+	epochClock.syncAt(cdc_test::epochTime + cdc_test::viewCheckInterval);
+	assert(epochClock.getSecondsOfDay() == (epochSecondsOfDay + cdc_test::viewCheckInterval) % revisedProfile.daySeconds);
+
+	// Offset views and epoch clocks in an orrery keep their phases along with the clocks they derive from
+	OrreryTimepiece derivedTimepiece;
+	CelestialDayClock* const base = derivedTimepiece.emplace("Base: ", earthDay.hours, earthDay.minutes);
+	std::vector<std::uint32_t> phases;
+
+	base->setSecondsOfDay(std::rand());
+	derivedTimepiece.add("Offset: ", new OffsetClockView(*base, cdc_test::viewOffsets[2]));
+	derivedTimepiece.add("Epoch: ", new EpochDayClock(*base, std::time(nullptr)));
+	derivedTimepiece.getDayPhases(phases);
+	assert(derivedTimepiece.reprofile(earthId, revisedId) == derivedTimepiece.getSize());
+	derivedTimepiece.snapshot(after);
+
+	for (size_t index = 0; index < after.getSize(); ++index) {
+		const int expected = DayPhase::toSecondsOfDay(phases[index], revisedProfile);
+		const int distance = (after.secondsOfDay[index] - expected + revisedProfile.daySeconds) % revisedProfile.daySeconds;
+
+		assert(after.profileIds[index] == revisedId);
+		assert(std::min(distance, revisedProfile.daySeconds - distance) <= cdc_test::reprofileToleranceSeconds);
+	}
+
+	// Reprofiling between ticks of a galaxy ticking on another thread leaves no clock on the old profile
+	timepiece->setTickThreadCount(1);
+	timepiece->renderTimes(times);
+
+	std::future<void> ticking = std::async(std::launch::async, [&timepiece]() {
+		for (int round = 0; round < cdc_test::reprofileRounds * 2; ++round) timepiece->tick();
+		});
+
+	for (int round = 0; round < cdc_test::reprofileRounds; ++round) {
+		const bool isRevised = round % 2 == 0;
+
+		timepiece->reprofile(isRevised ? earthId : revisedId, isRevised ? revisedId : earthId);
+	}
+
+	ticking.get();
+	timepiece->snapshot(after);
+	assert(std::find(after.profileIds.begin(), after.profileIds.end(), revisedId) == after.profileIds.end());
+
+	timepiece->reprofile(earthId, revisedId);
+	timepiece->renderTimes(times);
+	assert(std::vector<std::string>(times.begin(), times.end()) == timepiece->getTimes());
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void testRenderedViews() {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const std::unique_ptr<GalacticTimepiece> timepiece(new GalacticTimepiece());
+	OrreryTimepiece* orreryTimepiece = new OrreryTimepiece();
+	CelestialDayClock* base = orreryTimepiece->emplace("Base: ", earthDay.hours, earthDay.minutes);
+	RenderedTimes times;
+
+	std::cout << "\n\nTesting rendered derived clocks..." << std::endl;
+	orreryTimepiece->add("Offset: ", new OffsetClockView(*base, cdc_test::viewOffsets[1]));
+	orreryTimepiece->add("Epoch: ", new EpochDayClock(*base, std::time(nullptr)));
+	timepiece->add("Earth - ", orreryTimepiece);
+	timepiece->setTickThreadCount(1);
+
+	for (int tick = 0; tick < cdc_test::viewRenderTicks; ++tick) timepiece->tick();
+
+	// Epoch clocks follow the wall clock, so a render and a read straddling a second are retried
+	for (int attempt = 1; ; ++attempt) {
+		const std::time_t now = std::time(nullptr);
+
+		timepiece->tick();
+		timepiece->renderTimes(times);
+
+		const std::vector<std::string> expectedTimes = timepiece->getTimes();
+
+		if (std::time(nullptr) != now && attempt < cdc_test::viewRenderAttempts) continue;
+
+		assert(std::vector<std::string>(times.begin(), times.end()) == expectedTimes);
+		break;
+	}
+
+	std::cout << cdc_test::passed << std::endl;
+}
+
+static void displayCelestialTimepiece(CelestialTimepiece* timepiecePtr) {
+	const std::unique_ptr<CelestialTimepiece> timepiece(timepiecePtr);
+	std::chrono::time_point<std::chrono::steady_clock> nextTick =
+		std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+	GalacticTimepiece* const galacticTimepiece = dynamic_cast<GalacticTimepiece*>(timepiece.get());
+	TerminalRenderer renderer;
+	RenderedTimes times;
+
+	const auto drawTimes = [&]() {
+		if (galacticTimepiece == nullptr) {
+			renderer.draw(timepiece->getTimes());
+		}
+		else {
+			galacticTimepiece->renderTimes(times);
+			renderer.draw(times);
+		}
+		};
+
+	try {
+		drawTimes();
+		timepiece->tick();
+
+		while (true) {
+			std::this_thread::sleep_until(nextTick);
+			nextTick += std::chrono::seconds(1);
+			drawTimes();
+			timepiece->tick();
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Exception in displayCelestialTimepiece: " << e.what() << std::endl;
+	}
+}
+
+#ifdef __linux__
+static void benchmarkShards() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createBenchGalacticTimepiece(true));
+
+	for (const size_t shardCount : cdc_test::shardBenchCounts) {
+		ShardedGalaxy shardedGalaxy(shardCount);
+
+		for (size_t index = 0; index < timepiece->getTimepieceCount(); ++index)
+			shardedGalaxy.add(std::string(timepiece->getLabelAt(index)), timepiece->getTimepieceAt(index));
+
+		for (int tick = 0; tick < cdc_test::benchTicks; ++tick) shardedGalaxy.tick();
+
+		const ShardTickLatency& latency = shardedGalaxy.getTickLatency();
+
+		std::cout << shardCount << (shardCount == 1 ? " shard: " : " shards: ") << latency.getMeanNanoseconds() / 1000.0 <<
+			" us mean and " << latency.maxNanoseconds / 1000.0 << " us max tick latency, " <<
+			latency.getMeanNanoseconds() / static_cast<double>(shardedGalaxy.getSize()) << " ns per clock" << std::endl;
+	}
+}
+
+static void serveGalacticTimepiece() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createGalacticTimepiece());
+
+	try {
+		TimeServer server(*timepiece);
+		const std::uint16_t port = server.listenTcp();
+
+		std::cout << "\nServing times on 127.0.0.1:" << port << std::endl;
+		timepiece->startTicking();
+		server.run();
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Exception in serveGalacticTimepiece: " << e.what() << std::endl;
+	}
+}
+#endif
+
+static GalacticTimepiece* createBenchGalacticTimepiece(bool isPacked, int clockCount) {
+	const CelestialDay& earthDay = planetDayLengths.at(PlanetChoice::Earth);
+	const int halfCount = cdc_test::benchOrreryCount / 2;
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	std::vector<OrreryTimepiece*> orreryTimepieces;
+
+	for (int orreryIndex = 0; orreryIndex < cdc_test::benchOrreryCount; ++orreryIndex)
+		orreryTimepieces.push_back(new OrreryTimepiece());
+
+	// Heap clocks are allocated for each tick partition in turn, so neighbours go to different threads
+	for (int clockIndex = 0; clockIndex < clockCount; ++clockIndex) {
+		const std::string label = std::to_string(clockIndex) + ". ";
+
+		for (int step = 0; step < cdc_test::benchOrreryCount; ++step) {
+			OrreryTimepiece* const orreryTimepiece = orreryTimepieces[step % 2 * halfCount + step / 2];
+
+			if (isPacked) orreryTimepiece->emplace(label, earthDay.hours, earthDay.minutes);
+			else orreryTimepiece->add(label, new CelestialDayClock(earthDay.hours, earthDay.minutes));
+		}
+	}
+
+	for (int orreryIndex = 0; orreryIndex < cdc_test::benchOrreryCount; ++orreryIndex)
+		timepiece->add(std::to_string(orreryIndex) + ". ", orreryTimepieces[orreryIndex]);
+
+	return timepiece;
+}
+
+static double measureTicks(GalacticTimepiece& timepiece, size_t threadCount) {
+	timepiece.setTickThreadCount(threadCount);
+
+	return measureTickCost([&timepiece]() { timepiece.tick(); }, timepiece.getSize());
+}
+
+template<class Tick>
+static double measureTickCost(Tick tick, size_t clockCount) {
+	tick();
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int tickIndex = 0; tickIndex < cdc_test::benchTicks; ++tickIndex) tick();
+
+	const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+	return elapsed.count() / (static_cast<double>(cdc_test::benchTicks) * clockCount);
+}
+
+// Ticks the same clocks through virtual orrery ticks, the galaxy's tick plan and a static galaxy
+static void benchmarkDispatch(GalacticTimepiece& timepiece) {
+	std::vector<CelestialTimepiece*> orreryTimepieces;
+	StaticGalaxy staticGalaxy;
+
+	staticGalaxy.reserve(timepiece.getTimepieceCount());
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		const std::string label(timepiece.getLabelAt(orreryIndex));
+		const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+		StaticOrrery* const staticOrrery = staticGalaxy.add(label);
+
+		staticOrrery->reserve(orreryTimepiece.getSize());
+		orreryTimepieces.push_back(&timepiece.getTimepiece(label));
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index)
+			staticOrrery->add(std::string(orreryTimepiece.getLabelAt(index)), orreryTimepiece.getClockAt(index));
+	}
+
+	timepiece.setTickThreadCount(1);
+
+	const double virtualTicks = measureTickCost([&orreryTimepieces]() {
+		for (CelestialTimepiece* orreryTimepiece : orreryTimepieces) orreryTimepiece->tick();
+		}, timepiece.getSize());
+	const double plannedTicks = measureTickCost([&timepiece]() { timepiece.tick(); }, timepiece.getSize());
+	const double staticTicks = measureTickCost([&staticGalaxy]() { staticGalaxy.tick(); }, staticGalaxy.getSize());
+
+	std::cout << "Virtual orrery ticks: " << virtualTicks << " ns per clock, tick plan: " << plannedTicks <<
+		" ns, static galaxy: " << staticTicks << " ns" << std::endl;
+}
+
+#ifdef CDC_TRACE
+static void traceTick(GalacticTimepiece& timepiece) {
+	Tracer::clear();
+	Tracer::start();
+	timepiece.tick();
+	timepiece.getTimes();
+	Tracer::stop();
+	Tracer::writeChromeTrace(cdc_test::traceFileName);
+	std::cout << "Traced one tick and one getTimes call to " << cdc_test::traceFileName << std::endl;
+
+	for (const TraceTotal& total : Tracer::summarize()) {
+		std::cout << total.name << ": " << total.count << " calls, " << total.totalNanoseconds << " ns" << std::endl;
+	}
+
+	Tracer::clear();
+}
+#endif
+
+static void scatterClockTimes(GalacticTimepiece& timepiece) {
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		OrreryTimepiece& orreryTimepiece = timepiece.getTimepiece(std::string(timepiece.getLabelAt(orreryIndex)));
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index)
+			orreryTimepiece.getClockAt(index).setSecondsOfDay(std::rand());
+	}
+}
+
+// Renders a synchronized fleet and then the same fleet at scattered times, with and without caching
+static void benchmarkRenderCache() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createBenchGalacticTimepiece(true, cdc_test::renderBenchClockCount));
+	RenderedTimes times;
+
+	for (const bool isSynchronized : { true, false }) {
+		double renderCosts[2] = {};
+
+		if (!isSynchronized) scatterClockTimes(*timepiece);
+
+		for (const bool isCaching : { false, true }) {
+			timepiece->setRenderCaching(isCaching);
+			renderCosts[isCaching] = measureTickCost([&timepiece, &times]() { timepiece->renderTimes(times); }, timepiece->getSize());
+		}
+
+		const double hitCount = static_cast<double>(timepiece->getRenderCacheHitCount());
+		const double lookupCount = hitCount + static_cast<double>(timepiece->getRenderCacheMissCount());
+
+		std::cout << (isSynchronized ? "Synchronized fleet: " : "Scattered fleet: ") << renderCosts[0] <<
+			" ns per line uncached, " << renderCosts[1] << " ns cached, " << 100.0 * hitCount / lookupCount <<
+			"% cumulative hit rate" << std::endl;
+	}
+}
+
+// Ranks scattered clocks by seconds of day with a full radix sort, a comparison sort and an update after a tick
+static void benchmarkClockRanking() {
+	const std::unique_ptr<GalacticTimepiece> timepiece(createBenchGalacticTimepiece(true));
+	ClockRanking ranking;
+	ClockSnapshot clockSnapshot;
+	std::vector<std::uint32_t> indices;
+
+	scatterClockTimes(*timepiece);
+	timepiece->snapshot(clockSnapshot);
+
+	const int daySeconds = DayProfile::get(clockSnapshot.profileIds[0]).daySeconds;
+	const double radixCost = measureTickCost([&ranking, &clockSnapshot]() { ranking.rank(clockSnapshot); }, clockSnapshot.getSize());
+	const double comparisonCost = measureTickCost([&clockSnapshot, &indices]() {
+		indices.resize(clockSnapshot.getSize());
+
+		for (size_t index = 0; index < indices.size(); ++index) indices[index] = static_cast<std::uint32_t>(index);
+
+		std::stable_sort(indices.begin(), indices.end(), [&clockSnapshot](std::uint32_t first, std::uint32_t second) {
+			return clockSnapshot.secondsOfDay[first] < clockSnapshot.secondsOfDay[second];
+			});
+		}, clockSnapshot.getSize());
+	const double updateCost = measureTickCost([&ranking, &clockSnapshot, daySeconds]() {
+		for (int& secondsOfDay : clockSnapshot.secondsOfDay) secondsOfDay = secondsOfDay + 1 == daySeconds ? 0 : secondsOfDay + 1;
+
+		ranking.update(clockSnapshot);
+		}, clockSnapshot.getSize());
+
+	std::cout << "Ranking " << clockSnapshot.getSize() << " clocks: " << radixCost << " ns per clock radix sorted, " <<
+		comparisonCost << " ns comparison sorted, " << updateCost << " ns updated after a tick" << std::endl;
+}
+
+static void benchmarkTickLayouts() {
+	std::cout << "\nTicking " << cdc_test::benchOrreryCount * cdc_test::benchClockCount << " clocks " <<
+		cdc_test::benchTicks << " times on " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+	for (const bool isPacked : { false, true }) {
+		const std::unique_ptr<GalacticTimepiece> timepiece(createBenchGalacticTimepiece(isPacked));
+		const double singleThreaded = measureTicks(*timepiece, 1);
+		const double multiThreaded = measureTicks(*timepiece, 2);
+
+		std::cout << (isPacked ? "Packed slabs: " : "Interleaved heap clocks: ") << singleThreaded <<
+			" ns per clock on one thread, " << multiThreaded << " ns on two threads, " <<
+			singleThreaded / multiThreaded << "x scaling" << std::endl;
+
+		if (isPacked) benchmarkDispatch(*timepiece);
+#ifdef CDC_TRACE
+
+		if (isPacked) traceTick(*timepiece);
+#endif
+	}
+
+	benchmarkRenderCache();
+	benchmarkClockRanking();
+#ifdef __linux__
+
+	benchmarkShards();
+#endif
+}
+
+static void reportMemoryUsage() {
+	for (const int clockCount : cdc_test::memoryReportClockCounts) {
+		for (const bool isPacked : { false, true }) {
+			const std::unique_ptr<GalacticTimepiece> timepiece(createBenchGalacticTimepiece(isPacked, clockCount));
+			const MemoryUsage usage = timepiece->memoryUsage();
+			const double clocks = static_cast<double>(timepiece->getSize());
+
+			std::cout << timepiece->getSize() << (isPacked ? " packed clocks: " : " heap clocks: ") <<
+				usage.getTotalBytes() / clocks << " bytes per clock (state " << usage.stateBytes / clocks <<
+				", labels " << usage.labelBytes / clocks << ", containers " << usage.containerBytes / clocks <<
+				", allocator " << usage.allocatorOverheadBytes / clocks << ")" << std::endl;
+		}
+	}
+}
+
+static void loadGalacticTimepiece() {
+	std::string path;
+
+	std::cout << "\nEnter the path of a clock definition file: " << std::endl;
+	std::cin >> path;
+
+	try {
+		const auto start = std::chrono::steady_clock::now();
+		GalacticTimepiece* const timepiece = ClockLoader::loadFile(path);
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "Loaded " << timepiece->getSize() << " clocks in " << timepiece->getTimepieceCount() <<
+			" orreries in " << elapsed.count() << " ms" << std::endl;
+		displayCelestialTimepiece(timepiece);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Exception in loadGalacticTimepiece: " << e.what() << std::endl;
+	}
+}
+
+static void displayPlanetaryCDCMenu() {
+	const std::string range =
+		std::to_string(PlanetChoice::Mercury) + " and " + std::to_string(PlanetChoice::MaxChoice);
+	int choice = 0;
+	bool isValidChoice = false;
+
+	while (!isValidChoice) {
+		isValidChoice = true;
+		std::cout << "\n\nChoose a planet to display its standard clock: " << std::endl;
+
+		for (const auto& [planetChoice, planetName] : planetNames) {
+			std::cout << planetChoice << ". " << planetName << std::endl;
+		}
+
+		std::cin >> choice;
+
+		if (std::cin.fail() ||
+			choice < PlanetChoice::Mercury || choice > PlanetChoice::MaxChoice) {
+			isValidChoice = false;
+			std::cin.clear();
+			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			std::cout << "Invalid planet choice number. Please enter a choice number between "
+				+ range << std::endl;
+		}
+	}
+
+	const std::unordered_map<PlanetChoice, CelestialDay>::const_iterator itr =
+		planetDayLengths.find(static_cast<PlanetChoice>(choice));
+
+	if (itr != planetDayLengths.end())
+		displayCelestialTimepiece(new CelestialDayClock(itr->second.hours, itr->second.minutes));
+}
+
+static OrreryTimepiece* createOrreryTimepiece() {
+	OrreryTimepiece* timepiece = new OrreryTimepiece();
+	CelestialDayClock* clock = nullptr;
+
+	for (const auto& [planetChoice, celestialDay] : planetDayLengths) {
+		clock = new CelestialDayClock(celestialDay.hours, celestialDay.minutes);
+		clock->setHours(std::rand() % 2);
+		clock->setMinutesDigit1(std::rand() % cdc_test::senaryRadix);
+		clock->setMinutesDigit2(std::rand() % cdc_test::decimalRadix);
+		clock->setSecondsDigit1(std::rand() % cdc_test::senaryRadix);
+		clock->setSecondsDigit2(std::rand() % cdc_test::decimalRadix);
+		timepiece->add(planetNames.at(planetChoice) + cdc_test::delimiter + ' ', clock);
+	}
+
+	return timepiece;
+}
+
+static GalacticTimepiece* createGalacticTimepiece() {
+	GalacticTimepiece* timepiece = new GalacticTimepiece();
+	OrreryTimepiece* orreryTimepiece = createOrreryTimepiece();
+
+	timepiece->add("Star System A - ", orreryTimepiece);
+	orreryTimepiece = createOrreryTimepiece();
+	timepiece->add("Star System B - ", orreryTimepiece);
+
+	return timepiece;
+}
+
+static void displayCDCMenu() {
+	constexpr int planetChoice = 1;
+	constexpr int orreryChoice = planetChoice + 1;
+	constexpr int galacticChoice = orreryChoice + 1;
+	constexpr int benchmarkChoice = galacticChoice + 1;
+	constexpr int memoryChoice = benchmarkChoice + 1;
+	constexpr int loadChoice = memoryChoice + 1;
+#ifdef __linux__
+	constexpr int serveChoice = loadChoice + 1;
+	constexpr int lastChoice = serveChoice;
+#else
+	constexpr int lastChoice = loadChoice;
+#endif
+	const std::string range =
+		std::to_string(planetChoice) + " and " + std::to_string(lastChoice);
+	int choice = 0;
+	bool isValidChoice = false;
+
+	while (!isValidChoice) {
+		isValidChoice = true;
+		std::cout << "\n\nChoose to display a planet clock or an orrery timepiece: " << std::endl;
+		std::cout << std::to_string(planetChoice) + ". Display a planet clock" << std::endl;
+		std::cout << std::to_string(orreryChoice) + ". Display an orrery timepiece" << std::endl;
+		std::cout << std::to_string(galacticChoice) + ". Display a galactic timepiece" << std::endl;
+		std::cout << std::to_string(benchmarkChoice) + ". Benchmark tick layouts" << std::endl;
+		std::cout << std::to_string(memoryChoice) + ". Report memory usage" << std::endl;
+		std::cout << std::to_string(loadChoice) + ". Load a galactic timepiece from a file" << std::endl;
+#ifdef __linux__
+		std::cout << std::to_string(serveChoice) + ". Serve a galactic timepiece" << std::endl;
+#endif
+		std::cin >> choice;
+
+		if (std::cin.fail() || choice < planetChoice || choice > lastChoice) {
+			isValidChoice = false;
+			std::cin.clear();
+			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			std::cout << "Invalid menu choice number. Please enter a choice number between " +
+				range << std::endl;
+		}
+	}
+
+	if (choice == 1) displayPlanetaryCDCMenu();
+
+	if (choice == 2) displayCelestialTimepiece(createOrreryTimepiece());
+
+	if (choice == 3) displayCelestialTimepiece(createGalacticTimepiece());
+
+	if (choice == benchmarkChoice) benchmarkTickLayouts();
+
+	if (choice == memoryChoice) reportMemoryUsage();
+
+	if (choice == loadChoice) loadGalacticTimepiece();
+#ifdef __linux__
+
+	if (choice == serveChoice) serveGalacticTimepiece();
+#endif
+}
@@ -0,0 +1,29 @@
+#include "memoryusage.h"
+#include <algorithm>
+
+// Modeled on glibc malloc: an 8-byte chunk header, 16-byte rounding and a 32-byte minimum chunk
+static constexpr size_t allocationHeaderBytes = sizeof(size_t);
+static constexpr size_t allocationGranularity = 2 * sizeof(size_t);
+static constexpr size_t minAllocationBytes = 4 * sizeof(size_t);
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& usage) {
+	stateBytes += usage.stateBytes;
+	labelBytes += usage.labelBytes;
+	containerBytes += usage.containerBytes;
+	allocatorOverheadBytes += usage.allocatorOverheadBytes;
+
+	return *this;
+}
+
+void MemoryUsage::addAllocation(size_t bytes, size_t alignment) {
+	allocatorOverheadBytes += estimateAllocationOverhead(bytes, alignment);
+}
+
+size_t MemoryUsage::estimateAllocationOverhead(size_t bytes, size_t alignment) {
+	const size_t chunkBytes = std::max(bytes + allocationHeaderBytes + allocationGranularity - 1, minAllocationBytes) /
+		allocationGranularity * allocationGranularity;
+	// Over-aligned allocations may need up to this much padding before an aligned address
+	const size_t alignmentPadding = alignment > allocationGranularity ? alignment - allocationGranularity : 0;
+
+	return chunkBytes - bytes + alignmentPadding;
+}
@@ -0,0 +1,31 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+
+/* A breakdown of the bytes a timepiece holds. State is the timepieces' own objects, labels are the
+   interned label bytes they refer to, containers are the vectors and slack space that hold them,
+   and allocator overhead estimates the headers and rounding a typical malloc adds per allocation */
+struct MemoryUsage {
+	size_t stateBytes = 0;
+	size_t labelBytes = 0;
+	size_t containerBytes = 0;
+	size_t allocatorOverheadBytes = 0;
+
+	size_t getTotalBytes() const { return stateBytes + labelBytes + containerBytes + allocatorOverheadBytes; }
+
+	MemoryUsage& operator+=(const MemoryUsage& usage);
+
+	void addAllocation(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+	template<class T>
+	void addVector(const T& container) {
+		containerBytes += container.capacity() * sizeof(typename T::value_type);
+
+		if (container.capacity() > 0) addAllocation(container.capacity() * sizeof(typename T::value_type));
+	}
+
+	static size_t estimateAllocationOverhead(size_t bytes, size_t alignment = alignof(std::max_align_t));
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "offsetclockview.h"
+#include "dayphase.h"
+
+OffsetClockView::OffsetClockView(const CelestialDayClock& base, int offsetSeconds)
+	: DerivedDayClock(base.getProfile().bodyMaxHours, base.getProfile().bodyMaxMinutes), base(base) {
+	const int daySeconds = getProfile().daySeconds;
+
+	this->offsetSeconds = (offsetSeconds % daySeconds + daySeconds) % daySeconds;
+	sync();
+}
+
+// The offset is a fraction of the day, like a longitude, so it keeps its phase on the base's new day
+void OffsetClockView::sync() {
+	const DayProfile::Id baseProfileId = base.getProfileId();
+
+	if (baseProfileId != getProfileId()) {
+		offsetSeconds = DayPhase::toSecondsOfDay(DayPhase::fromSecondsOfDay(offsetSeconds, getProfile()), base.getProfile());
+		syncProfile(baseProfileId, 0);
+	}
+
+	syncSecondsOfDay(base.getSecondsOfDay() + offsetSeconds);
+}
+
+void OffsetClockView::reprofile(DayProfile::Id) { sync(); }
+
+// A view moves with its base, so it follows ticks unless its base follows something else
+bool OffsetClockView::isTickDriven() const {
+	const DerivedDayClock* const derivedBase = dynamic_cast<const DerivedDayClock*>(&base);
+
+	return derivedBase == nullptr || derivedBase->isTickDriven();
+}
+
+MemoryUsage OffsetClockView::memoryUsage() const {
+	MemoryUsage usage;
+
+	usage.stateBytes = sizeof(OffsetClockView);
+
+	return usage;
+}
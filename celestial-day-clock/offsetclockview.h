@@ -0,0 +1,34 @@
+#ifndef OFFSET_CLOCK_VIEW_H
+#define OFFSET_CLOCK_VIEW_H
+
+#include "deriveddayclock.h"
+
+/* A clock that shows a base clock's time shifted by a constant number of seconds, as the same
+   celestial body observed from another longitude. Only the base needs to tick. A view always shows
+   its base's day, so syncing follows the base onto a new day length with the offset kept at the same
+   phase. An orrery only accepts a view whose base it already holds, so the base outlives the view */
+class OffsetClockView : public DerivedDayClock {
+public:
+	OffsetClockView(const CelestialDayClock& base, int offsetSeconds);
+
+	const CelestialDayClock& getBase() const { return base; }
+
+	int getOffsetSeconds() const { return offsetSeconds; }
+
+	const CelestialDayClock* getSource() const override { return &base; }
+
+	bool isTickDriven() const override;
+
+	void sync() override;
+
+	// Follows the base, as a view cannot hold a day length of its own
+	void reprofile(DayProfile::Id toProfileId) override;
+
+	MemoryUsage memoryUsage() const override;
+
+private:
+	const CelestialDayClock& base;
+	int offsetSeconds;
+};
+
+#endif
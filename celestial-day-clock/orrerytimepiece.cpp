@@ -1,31 +1,83 @@
 #include "orrerytimepiece.h"
+#include "dayphase.h"
+#include "tickplan.h"
+#include "tracer.h"
+#include <algorithm>
+#include <functional>
+#include <new>
 #include <stdexcept>
 #include <iostream>
 
 OrreryTimepiece::~OrreryTimepiece() { deleteClocks(); }
 
-void OrreryTimepiece::add(const std::string& label, CelestialDayClock* clock) {
-	if (clock == nullptr) throw std::invalid_argument("Cannot add a null clock");
+// Clocks are sorted by their dynamic type, as the tick plan ticks its clocks without virtual dispatch
+bool OrreryTimepiece::add(const std::string& label, CelestialDayClock* clock) {
+	DerivedDayClock* const view = dynamic_cast<DerivedDayClock*>(clock);
 
-	for (const auto& [existingLabel, existingClock] : clocks) {
-		if (existingClock == nullptr)
-			throw std::runtime_error("Null clock pointer encountered in add");
+	// A source already in this orrery is freed with it, and is synced or ticked before the new clock
+	if (view != nullptr && view->getSource() != nullptr && std::none_of(clocks.begin(), clocks.end(),
+		[view](const std::pair<LabelPool::Id, CelestialDayClock*>& entry) { return entry.second == view->getSource(); }))
+		throw std::invalid_argument("Clock with label " + label + " derives from a clock outside its orrery");
 
-		if (label == existingLabel) {
-			std::cerr << "Clock with label " << label << " already exists" << std::endl;
-			return;
-		}
+	if (!insert(label, clock)) return false;
+
+	if (view != nullptr) views.push_back(view);
+	else tickedClocks.push_back(clock);
+
+	return true;
+}
+
+CelestialDayClock* OrreryTimepiece::emplace(const std::string& label, int h, int m) {
+	ClockSlab& slab = getFreeSlab();
+	CelestialDayClock* const clock = new (slab.bytes + slab.used * sizeof(CelestialDayClock)) CelestialDayClock(h, m);
+
+	if (!insert(label, clock)) {
+		clock->~CelestialDayClock();
+
+		return nullptr;
 	}
 
-	clocks.emplace_back(label, clock);
+	++slab.used;
+	tickedClocks.push_back(clock);
+
+	return clock;
+}
+
+CelestialDayClock* OrreryTimepiece::emplaceUnchecked(LabelPool::Id label, const CelestialDayClock& clock) {
+	ClockSlab& slab = getFreeSlab();
+	CelestialDayClock* const copy = new (slab.bytes + slab.used * sizeof(CelestialDayClock)) CelestialDayClock(clock);
+
+	++slab.used;
+	clocks.emplace_back(label, copy);
+	tickedClocks.push_back(copy);
+	revision = nextRevision();
+
+	return copy;
+}
+
+void OrreryTimepiece::reserve(size_t clockCount) {
+	clocks.reserve(clockCount);
+	tickedClocks.reserve(clockCount);
+	slabs.reserve((clockCount + slabClockCount - 1) / slabClockCount);
+}
+
+bool OrreryTimepiece::isTickDriven() const {
+	return std::all_of(views.begin(), views.end(), [](const DerivedDayClock* view) { return view->isTickDriven(); });
+}
+
+void OrreryTimepiece::syncViews() const {
+	for (DerivedDayClock* view : views) view->sync();
 }
 
 CelestialDayClock& OrreryTimepiece::getClock(const std::string& searchLabel) {
+	LabelPool::Id searchId = 0;
+	const bool isInterned = LabelPool::find(searchLabel, searchId);
+
 	for (const auto& [label, clock] : clocks) {
 		if (clock == nullptr)
 			throw std::runtime_error("Null clock pointer encountered in getClock");
 
-		if (searchLabel == label) return *clock;
+		if (isInterned && searchId == label) return *clock;
 	}
 
 	throw std::runtime_error("Clock with label " + searchLabel + " not found");
@@ -34,47 +86,237 @@ CelestialDayClock& OrreryTimepiece::getClock(const std::string& searchLabel) {
 void OrreryTimepiece::clear() {
 	deleteClocks();
 	clocks.clear();
+	tickedClocks.clear();
+	views.clear();
+	slabs.clear();
+	revision = nextRevision();
+}
+
+void OrreryTimepiece::snapshot(ClockSnapshot& clockSnapshot) const {
+	clockSnapshot.tick = tickCount;
+	clockSnapshot.profileIds.clear();
+	clockSnapshot.secondsOfDay.clear();
+	syncViews();
+
+	for (const auto& [label, clock] : clocks) {
+		if (clock == nullptr)
+			throw std::runtime_error("Null clock pointer encountered in snapshot");
+
+		clockSnapshot.profileIds.push_back(clock->getProfileId());
+		clockSnapshot.secondsOfDay.push_back(clock->getSecondsOfDay());
+	}
+}
+
+void OrreryTimepiece::getDayPhases(std::vector<std::uint32_t>& phases) const {
+	ClockSnapshot clockSnapshot;
+
+	snapshot(clockSnapshot);
+	DayPhase::fromSnapshot(clockSnapshot, phases);
+}
+
+void OrreryTimepiece::setDayPhases(const std::vector<std::uint32_t>& phases) {
+	ClockSnapshot clockSnapshot;
+
+	snapshot(clockSnapshot);
+	DayPhase::toSnapshot(phases, clockSnapshot);
+
+	for (size_t index = 0; index < clocks.size(); ++index)
+		clocks[index].second->setSecondsOfDay(clockSnapshot.secondsOfDay[index]);
+}
+
+size_t OrreryTimepiece::reprofile(DayProfile::Id fromProfileId, DayProfile::Id toProfileId) {
+	CDC_TRACE_SCOPE("OrreryTimepiece::reprofile");
+	const DayProfile& fromProfile = DayProfile::get(fromProfileId);
+	const DayProfile& toProfile = DayProfile::get(toProfileId);
+	std::vector<CelestialDayClock*> matches;
+	std::vector<int> secondsOfDay;
+	size_t viewCount = 0;
+
+	if (fromProfileId == toProfileId) return 0;
+
+	// Views on the old profile are then exactly those that follow a clock moved below
+	syncViews();
+
+	for (CelestialDayClock* clock : tickedClocks) {
+		if (clock == nullptr)
+			throw std::runtime_error("Null clock pointer encountered in reprofile");
+
+		if (clock->getProfileId() != fromProfileId) continue;
+
+		matches.push_back(clock);
+		secondsOfDay.push_back(clock->getSecondsOfDay());
+	}
+
+	DayPhase::rescale(secondsOfDay, fromProfile, toProfile);
+
+	for (size_t index = 0; index < matches.size(); ++index)
+		matches[index]->setProfile(toProfileId, secondsOfDay[index]);
+
+	// Derived clocks are rescaled after the clocks they may derive from, through their own anchors and offsets
+	for (DerivedDayClock* view : views) {
+		if (view->getProfileId() != fromProfileId) continue;
+
+		view->reprofile(toProfileId);
+		++viewCount;
+	}
+
+	// Rendered times are laid out by profile, so layouts built before the change must be rebuilt
+	if (!matches.empty() || viewCount > 0) revision = nextRevision();
+
+	return matches.size() + viewCount;
 }
 
-std::vector<std::string> OrreryTimepiece::getTimesMilitary() const {
+std::vector<std::string> OrreryTimepiece::getTimesMilitary() const { return getTimesMilitary(getRenderCache()); }
+
+std::vector<std::string> OrreryTimepiece::getTimesMilitary(RenderCache& cache) const {
+	CDC_TRACE_SCOPE("OrreryTimepiece::getTimesMilitary");
 	std::vector<std::string> times;
 
+	syncViews();
+
 	for (const auto& [label, clock] : clocks) {
 		if (clock == nullptr)
 			throw std::runtime_error("Null clock pointer encountered in getTimesMilitary");
 
-		times.emplace_back(label + clock->getTimeMilitary());
+		char time[CelestialDayClock::maxTimeLength];
+
+		times.emplace_back(LabelPool::prefix(label, { time, cache.formatTimeMilitary(*clock, time) }));
 	}
 
 	return times;
 }
 
-std::vector<std::string> OrreryTimepiece::getTimes() {
+std::vector<std::string> OrreryTimepiece::getTimes() { return getTimes(getRenderCache()); }
+
+std::vector<std::string> OrreryTimepiece::getTimes(RenderCache& cache) {
+	CDC_TRACE_SCOPE("OrreryTimepiece::getTimes");
 	std::vector<std::string> times;
 
+	syncViews();
+
 	for (const auto& [label, clock] : clocks) {
 		if (clock == nullptr)
 			throw std::runtime_error("Null clock pointer encountered in getTimes");
 
-		times.emplace_back(label + clock->getTime());
+		char time[CelestialDayClock::maxTimeLength];
+
+		times.emplace_back(LabelPool::prefix(label, { time, cache.formatTime(*clock, time) }));
 	}
 
 	return times;
 }
 
+MemoryUsage OrreryTimepiece::memoryUsage() const {
+	MemoryUsage usage;
+	size_t slabClocks = 0;
+
+	usage.stateBytes = sizeof(OrreryTimepiece);
+	usage.addVector(clocks);
+	usage.addVector(tickedClocks);
+	usage.addVector(views);
+	usage.addVector(slabs);
+
+	for (const auto& [label, clock] : clocks) {
+		if (clock == nullptr)
+			throw std::runtime_error("Null clock pointer encountered in memoryUsage");
+
+		usage += clock->memoryUsage();
+		usage.labelBytes += LabelPool::get(label).size();
+	}
+
+	// Slab space not yet holding a clock counts as container slack
+	for (const std::unique_ptr<ClockSlab>& slab : slabs) {
+		usage.containerBytes += sizeof(ClockSlab) - slab->used * sizeof(CelestialDayClock);
+		usage.addAllocation(sizeof(ClockSlab), alignof(ClockSlab));
+		slabClocks += slab->used;
+	}
+
+	for (size_t index = slabClocks; index < tickedClocks.size(); ++index) usage.addAllocation(sizeof(CelestialDayClock));
+
+	for (const DerivedDayClock* view : views) usage.addAllocation(view->memoryUsage().stateBytes);
+
+	if (renderCache != nullptr) {
+		usage += renderCache->memoryUsage();
+		usage.addAllocation(sizeof(RenderCache));
+	}
+
+	return usage;
+}
+
+void OrreryTimepiece::compileTickPlan(TickPlan& plan) {
+	plan.addClocks(tickedClocks.data(), tickedClocks.size());
+	plan.addCounter(tickCount);
+	plan.addBoundary();
+}
+
 void OrreryTimepiece::tick() {
-	for (std::pair<std::string, CelestialDayClock*>& clock : clocks) {
-		if (clock.second == nullptr)
+	CDC_TRACE_SCOPE("OrreryTimepiece::tick");
+
+	for (CelestialDayClock* clock : tickedClocks) {
+		if (clock == nullptr)
 			throw std::runtime_error("Null clock pointer encountered in tick");
 
-		clock.second->tick();
+		clock->tick();
 	}
+
+	++tickCount;
+}
+
+// Kept between calls, and replaced by a larger one once the orrery outgrows it
+RenderCache& OrreryTimepiece::getRenderCache() const {
+	const size_t capacity = std::min(RenderCache::defaultCapacity, 2 * clocks.size());
+
+	if (renderCache == nullptr || renderCache->getCapacity() < capacity) renderCache = std::make_unique<RenderCache>(capacity);
+
+	return *renderCache;
+}
+
+OrreryTimepiece::ClockSlab& OrreryTimepiece::getFreeSlab() {
+	if (slabs.empty() || slabs.back()->used == slabClockCount) slabs.push_back(std::make_unique<ClockSlab>());
+
+	return *slabs.back();
+}
+
+bool OrreryTimepiece::insert(const std::string& label, CelestialDayClock* clock) {
+	if (clock == nullptr) throw std::invalid_argument("Cannot add a null clock");
+
+	const LabelPool::Id labelId = LabelPool::intern(label);
+
+	for (const auto& [existingLabel, existingClock] : clocks) {
+		if (existingClock == nullptr)
+			throw std::runtime_error("Null clock pointer encountered in add");
+
+		if (labelId == existingLabel) {
+			std::cerr << "Clock with label " << label << " already exists" << std::endl;
+			return false;
+		}
+	}
+
+	clocks.emplace_back(labelId, clock);
+	revision = nextRevision();
+
+	return true;
 }
 
 void OrreryTimepiece::deleteClocks() {
-	for (std::pair<std::string, CelestialDayClock*>& clock : clocks) {
+	constexpr size_t slabBytes = sizeof(ClockSlab::bytes);
+	std::vector<const unsigned char*> slabStarts;
+
+	for (const std::unique_ptr<ClockSlab>& slab : slabs) slabStarts.push_back(slab->bytes);
+
+	std::sort(slabStarts.begin(), slabStarts.end(), std::less<>());
+
+	for (std::pair<LabelPool::Id, CelestialDayClock*>& clock : clocks) {
 		if (clock.second != nullptr) {
-			delete clock.second;
+			const unsigned char* const address = reinterpret_cast<const unsigned char*>(clock.second);
+			const auto slabStart = std::upper_bound(slabStarts.begin(), slabStarts.end(), address, std::less<>());
+
+			// Slab clocks are only destroyed, as their memory goes with the slab
+			if (slabStart != slabStarts.begin() && std::less<>()(address, *(slabStart - 1) + slabBytes))
+				clock.second->~CelestialDayClock();
+			else
+				delete clock.second;
+
 			clock.second = nullptr;
 		}
 	}
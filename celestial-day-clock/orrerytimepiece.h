@@ -1,33 +1,109 @@
 #ifndef ORRERY_TIMEPIECE_H
 #define ORRERY_TIMEPIECE_H
 
+#include "cacheline.h"
 #include "celestialtimepiece.h"
 #include "celestialdayclock.h"
+#include "clocksnapshot.h"
+#include "labelpool.h"
+#include "rendercache.h"
+#include "deriveddayclock.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <utility>
 
-// A collection of CelestialDayClocks that keeps track of a star system's time
+/* A collection of CelestialDayClocks that keeps track of a star system's time. Derived clocks such
+   as offset views and epoch clocks are not ticked; syncViews, which every read runs, syncs them.
+   Clocks created with emplace are packed into cache-line-aligned slabs that only this orrery uses,
+   so orreries ticked on different threads never write to the same cache line */
 class OrreryTimepiece : public CelestialTimepiece {
 public:
+	static constexpr size_t slabClockCount = 64;
+
 	~OrreryTimepiece();
 
 	size_t getSize() const { return clocks.size(); }
 
-	void add(const std::string& label, CelestialDayClock* clock);
+	size_t getRevision() const override { return std::max(revision, lastProfileRevision().load()); }
+
+	std::uint64_t getTickCount() const { return tickCount; }
+
+	// Derived clocks are kept apart from ticked clocks whatever the pointer's static type. Returns whether
+	// the orrery took ownership, which it does not when the label is already in use. Throws, also without
+	// taking ownership, for a derived clock whose source is not already in this orrery
+	bool add(const std::string& label, CelestialDayClock* clock);
+
+	CelestialDayClock* emplace(const std::string& label, int h, int m);
+
+	// Copies a clock into a slab under an interned label the caller has already checked is not in use
+	CelestialDayClock* emplaceUnchecked(LabelPool::Id label, const CelestialDayClock& clock);
+
+	void reserve(size_t clockCount);
+
+	size_t getViewCount() const { return views.size(); }
+
+	// Whether every clock advances one second per tick, which derived clocks following the wall time do not
+	bool isTickDriven() const;
+
+	void syncViews() const;
 
 	CelestialDayClock& getClock(const std::string& searchLabel);
 
+	std::string_view getLabelAt(size_t index) const { return LabelPool::get(clocks[index].first); }
+
+	const CelestialDayClock& getClockAt(size_t index) const { return *clocks[index].second; }
+
+	CelestialDayClock& getClockAt(size_t index) { return *clocks[index].second; }
+
 	void clear();
 
+	void snapshot(ClockSnapshot& clockSnapshot) const;
+
+	void getDayPhases(std::vector<std::uint32_t>& phases) const;
+
+	void setDayPhases(const std::vector<std::uint32_t>& phases);
+
+	// Moves every clock on one day profile to another, keeping each at the same phase of its day
+	size_t reprofile(DayProfile::Id fromProfileId, DayProfile::Id toProfileId);
+
 	std::vector<std::string> getTimesMilitary() const;
 
+	std::vector<std::string> getTimesMilitary(RenderCache& cache) const;
+
 	std::vector<std::string> getTimes() override;
 
+	std::vector<std::string> getTimes(RenderCache& cache);
+
+	MemoryUsage memoryUsage() const override;
+
+	void compileTickPlan(TickPlan& plan) override;
+
 	void tick() override;
 
 private:
-	std::vector<std::pair<std::string, CelestialDayClock*>> clocks;
+	struct ClockSlab {
+		alignas(cacheLineSize) unsigned char bytes[slabClockCount * sizeof(CelestialDayClock)];
+		size_t used = 0;
+	};
+
+	std::vector<std::pair<LabelPool::Id, CelestialDayClock*>> clocks;
+	std::vector<CelestialDayClock*> tickedClocks;
+	std::vector<DerivedDayClock*> views;
+	std::vector<std::unique_ptr<ClockSlab>> slabs;
+	mutable std::unique_ptr<RenderCache> renderCache;
+	PaddedAtomic<std::uint64_t> tickCount = 0;
+	size_t revision = 0;
+
+	ClockSlab& getFreeSlab();
+
+	RenderCache& getRenderCache() const;
+
+	bool insert(const std::string& label, CelestialDayClock* clock);
 
 	void deleteClocks();
 };
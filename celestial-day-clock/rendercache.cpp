@@ -0,0 +1,29 @@
+#include "rendercache.h"
+#include <bit>
+
+RenderCache::RenderCache(size_t capacity) {
+	const size_t slotCount = std::bit_ceil(capacity < 2 ? size_t{ 2 } : capacity);
+
+	entries.resize(slotCount);
+	shift = 64 - std::countr_zero(slotCount);
+}
+
+double RenderCache::getHitRate() const {
+	const std::uint64_t lookupCount = hitCount + missCount;
+
+	return lookupCount == 0 ? 0.0 : static_cast<double>(hitCount) / static_cast<double>(lookupCount);
+}
+
+void RenderCache::resetCounters() {
+	hitCount = 0;
+	missCount = 0;
+}
+
+MemoryUsage RenderCache::memoryUsage() const {
+	MemoryUsage usage;
+
+	usage.stateBytes = sizeof(RenderCache);
+	usage.addVector(entries);
+
+	return usage;
+}
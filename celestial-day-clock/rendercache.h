@@ -0,0 +1,105 @@
+#ifndef RENDER_CACHE_H
+#define RENDER_CACHE_H
+
+#include "celestialdayclock.h"
+#include "memoryusage.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/* Memoizes formatted times for clocks that share a day profile and a time of day, so a fleet of
+   synchronized clocks is formatted once per distinct time and copied after that. Entries are keyed
+   by the profile and the clock's digits, which determine the rendered text, so they never go stale
+   and need no clearing between ticks; a direct-mapped slot is simply overwritten by the next key
+   that hashes to it. Not thread-safe, so concurrent renderers each use their own cache */
+class RenderCache {
+public:
+	static constexpr size_t defaultCapacity = 1024;
+
+	explicit RenderCache(size_t capacity = defaultCapacity);
+
+	size_t getCapacity() const { return entries.size(); }
+
+	std::uint64_t getHitCount() const { return hitCount; }
+
+	std::uint64_t getMissCount() const { return missCount; }
+
+	double getHitRate() const;
+
+	void resetCounters();
+
+	MemoryUsage memoryUsage() const;
+
+	size_t formatTimeMilitary(const CelestialDayClock& clock, char* out) { return format(clock, out, true); }
+
+	size_t formatTime(const CelestialDayClock& clock, char* out) { return format(clock, out, false); }
+
+private:
+	static constexpr std::uint64_t emptyKey = UINT64_MAX;
+	static constexpr std::uint64_t militaryFlag = std::uint64_t{ 1 } << 31;
+
+	struct Entry {
+		std::uint64_t key = emptyKey;
+		std::uint8_t length = 0;
+		char time[CelestialDayClock::maxTimeLength];
+	};
+
+	std::vector<Entry> entries;
+	int shift = 0;
+	std::uint64_t hitCount = 0;
+	std::uint64_t missCount = 0;
+
+	size_t format(const CelestialDayClock& clock, char* out, bool isMilitary);
+
+	static void copy(char* out, const char* time, size_t length);
+};
+
+// Two overlapping fixed-size copies compile to plain moves, where a variable-length memcpy is a call
+inline void RenderCache::copy(char* out, const char* time, size_t length) {
+	if (length >= 16) {
+		std::memcpy(out, time, 16);
+		std::memcpy(out + length - 16, time + length - 16, 16);
+	}
+	else if (length >= 8) {
+		std::memcpy(out, time, 8);
+		std::memcpy(out + length - 8, time + length - 8, 8);
+	}
+	else if (length >= 4) {
+		std::memcpy(out, time, 4);
+		std::memcpy(out + length - 4, time + length - 4, 4);
+	}
+	else {
+		for (size_t index = 0; index < length; ++index) out[index] = time[index];
+	}
+}
+
+// Formatting is defined here so that render loops can inline the hit path
+inline size_t RenderCache::format(const CelestialDayClock& clock, char* out, bool isMilitary) {
+	static_assert(CelestialDayClock::radix <= 16 && CelestialDayClock::secondaryRadix <= 16,
+		"Time digits must fit in four bits of a render key");
+
+	const std::uint64_t key = static_cast<std::uint64_t>(clock.getHours()) | (isMilitary ? militaryFlag : 0) |
+		static_cast<std::uint64_t>(clock.getMinutesDigit1()) << 32 | static_cast<std::uint64_t>(clock.getMinutesDigit2()) << 36 |
+		static_cast<std::uint64_t>(clock.getSecondsDigit1()) << 40 | static_cast<std::uint64_t>(clock.getSecondsDigit2()) << 44 |
+		static_cast<std::uint64_t>(clock.getProfileId()) << 48;
+	Entry& entry = entries[(key * 0x9E3779B97F4A7C15ULL) >> shift];
+
+	if (entry.key == key) {
+		++hitCount;
+		copy(out, entry.time, entry.length);
+
+		return entry.length;
+	}
+
+	const size_t length = isMilitary ? clock.formatTimeMilitary(out) : clock.formatTime(out);
+
+	++missCount;
+	entry.key = key;
+	entry.length = static_cast<std::uint8_t>(length);
+	copy(entry.time, out, length);
+
+	return length;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef RENDERED_TIMES_H
+#define RENDERED_TIMES_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Times rendered into one contiguous buffer with a view per line, which keeps its layout so that
+   re-rendering the same timepiece allocates nothing */
+class RenderedTimes {
+public:
+	size_t getSize() const { return lines.size(); }
+
+	std::string_view operator[](size_t index) const { return lines[index]; }
+
+	const std::vector<std::string_view>& getLines() const { return lines; }
+
+	std::vector<std::string_view>::const_iterator begin() const { return lines.begin(); }
+
+	std::vector<std::string_view>::const_iterator end() const { return lines.end(); }
+
+private:
+	friend class GalacticTimepiece;
+
+	std::string buffer;
+	std::vector<std::string_view> lines;
+	std::vector<size_t> lineOffsets;
+	std::vector<size_t> orreryLines;
+	const void* source = nullptr;
+	size_t revision = 0;
+	bool isMilitary = false;
+};
+
+#endif
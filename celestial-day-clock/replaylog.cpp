@@ -0,0 +1,293 @@
+#include "replaylog.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+static void writeUnsigned(std::ostream& out, std::uint64_t value, int byteCount) {
+	for (int byte = 0; byte < byteCount; ++byte) {
+		out.put(static_cast<char>(value & 0xFF));
+		value >>= 8;
+	}
+}
+
+static void writeInt(std::ostream& out, int value) {
+	writeUnsigned(out, static_cast<std::uint32_t>(value), sizeof(std::uint32_t));
+}
+
+static void writeString(std::ostream& out, const std::string& value) {
+	writeUnsigned(out, value.size(), sizeof(std::uint32_t));
+	out.write(value.data(), value.size());
+}
+
+static std::uint64_t readUnsigned(std::istream& in, int byteCount) {
+	std::uint64_t value = 0;
+
+	for (int byte = 0; byte < byteCount; ++byte) {
+		const int character = in.get();
+
+		if (character == std::char_traits<char>::eof())
+			throw std::runtime_error("Truncated replay log");
+
+		value |= static_cast<std::uint64_t>(character & 0xFF) << (byte * 8);
+	}
+
+	return value;
+}
+
+static int readInt(std::istream& in) {
+	return static_cast<int>(static_cast<std::uint32_t>(readUnsigned(in, sizeof(std::uint32_t))));
+}
+
+// Grows the string only as bytes arrive, so a corrupt length fails as truncation instead of allocating
+static std::string readString(std::istream& in) {
+	constexpr size_t chunkSize = 4096;
+	const std::uint64_t size = readUnsigned(in, sizeof(std::uint32_t));
+	std::string value;
+
+	while (value.size() < size) {
+		const size_t offset = value.size();
+		const size_t chunk = static_cast<size_t>(std::min<std::uint64_t>(size - offset, chunkSize));
+
+		value.resize(offset + chunk);
+
+		if (!in.read(value.data() + offset, static_cast<std::streamsize>(chunk)))
+			throw std::runtime_error("Truncated replay log");
+	}
+
+	return value;
+}
+
+// Adds an orrery unless its label is taken, in which case the log is corrupt and the orrery is freed
+static OrreryTimepiece& addOrreryTimepiece(GalacticTimepiece& timepiece, const std::string& label) {
+	std::unique_ptr<OrreryTimepiece> orrery(new OrreryTimepiece());
+
+	if (!timepiece.add(label, orrery.get())) throw std::runtime_error("Timepiece with label " + label + " already exists");
+
+	return *orrery.release();
+}
+
+static CelestialDayClock& emplaceClock(OrreryTimepiece& orrery, const std::string& label, int h, int m) {
+	CelestialDayClock* const clock = orrery.emplace(label, h, m);
+
+	if (clock == nullptr) throw std::runtime_error("Clock with label " + label + " already exists");
+
+	return *clock;
+}
+
+ReplayRecorder::ReplayRecorder(GalacticTimepiece& timepiece, std::ostream& out) :
+	timepiece(timepiece), out(out) {
+	out.write(magic, sizeof(magic));
+	out.put(static_cast<char>(version));
+	writeState();
+	listenerId = timepiece.addTickListener([this](std::uint64_t) { ++pendingTicks; });
+}
+
+ReplayRecorder::~ReplayRecorder() {
+	timepiece.removeTickListener(listenerId);
+	flush();
+}
+
+void ReplayRecorder::addTimepiece(const std::string& label) {
+	addOrreryTimepiece(timepiece, label);
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::AddTimepiece));
+	writeString(out, label);
+}
+
+void ReplayRecorder::addClock(const std::string& timepieceLabel, const std::string& clockLabel,
+	int h, int m) {
+	emplaceClock(timepiece.getTimepiece(timepieceLabel), clockLabel, h, m);
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::AddClock));
+	writeString(out, timepieceLabel);
+	writeString(out, clockLabel);
+	writeInt(out, h);
+	writeInt(out, m);
+}
+
+void ReplayRecorder::setTime(const std::string& timepieceLabel, const std::string& clockLabel,
+	int hours, int minutesDigit1, int minutesDigit2, int secondsDigit1, int secondsDigit2) {
+	CelestialDayClock& clock = timepiece.getTimepiece(timepieceLabel).getClock(clockLabel);
+
+	clock.setHours(hours);
+	clock.setMinutesDigit1(minutesDigit1);
+	clock.setMinutesDigit2(minutesDigit2);
+	clock.setSecondsDigit1(secondsDigit1);
+	clock.setSecondsDigit2(secondsDigit2);
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::SetTime));
+	writeString(out, timepieceLabel);
+	writeString(out, clockLabel);
+
+	for (const int value : { hours, minutesDigit1, minutesDigit2, secondsDigit1, secondsDigit2 })
+		writeInt(out, value);
+}
+
+void ReplayRecorder::removeTimepiece(const std::string& label) {
+	delete timepiece.remove(label);
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::RemoveTimepiece));
+	writeString(out, label);
+}
+
+void ReplayRecorder::setDayPhases(const std::vector<std::uint32_t>& phases) {
+	timepiece.setDayPhases(phases);
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::SetDayPhases));
+	writeUnsigned(out, phases.size(), sizeof(std::uint32_t));
+
+	for (const std::uint32_t phase : phases) writeUnsigned(out, phase, sizeof(std::uint32_t));
+}
+
+size_t ReplayRecorder::reprofile(int fromHours, int fromMinutes, int toHours, int toMinutes) {
+	const size_t clockCount = timepiece.reprofile(DayProfile::fromBodyMaximums(fromHours, fromMinutes),
+		DayProfile::fromBodyMaximums(toHours, toMinutes));
+
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::Reprofile));
+
+	for (const int value : { fromHours, fromMinutes, toHours, toMinutes }) writeInt(out, value);
+
+	return clockCount;
+}
+
+void ReplayRecorder::rewind(const std::string& timepieceLabel, const std::string& clockLabel, std::uint64_t seconds) {
+	timepiece.getTimepiece(timepieceLabel).getClock(clockLabel).rewind(seconds);
+	flushTicks();
+	out.put(static_cast<char>(ReplayEvent::Rewind));
+	writeString(out, timepieceLabel);
+	writeString(out, clockLabel);
+	writeUnsigned(out, seconds, sizeof(std::uint64_t));
+}
+
+void ReplayRecorder::flush() {
+	timepiece.stopTicking();
+	flushTicks();
+	out.flush();
+}
+
+void ReplayRecorder::flushTicks() {
+	if (pendingTicks == 0) return;
+
+	out.put(static_cast<char>(ReplayEvent::Ticks));
+	writeUnsigned(out, pendingTicks, sizeof(std::uint64_t));
+	pendingTicks = 0;
+}
+
+void ReplayRecorder::writeState() {
+	timepiece.stopTicking();
+	out.put(static_cast<char>(ReplayEvent::State));
+	writeUnsigned(out, timepiece.getTimepieceCount(), sizeof(std::uint32_t));
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orrery = timepiece.getTimepieceAt(orreryIndex);
+
+		orrery.syncViews();
+		writeString(out, std::string(timepiece.getLabelAt(orreryIndex)));
+		writeUnsigned(out, orrery.getSize(), sizeof(std::uint32_t));
+
+		for (size_t index = 0; index < orrery.getSize(); ++index) {
+			const CelestialDayClock& clock = orrery.getClockAt(index);
+
+			writeString(out, std::string(orrery.getLabelAt(index)));
+			writeInt(out, clock.getProfile().bodyMaxHours);
+			writeInt(out, clock.getProfile().bodyMaxMinutes);
+			writeInt(out, clock.getSecondsOfDay());
+		}
+	}
+}
+
+std::uint64_t ReplayPlayer::replay(std::istream& in, GalacticTimepiece& timepiece) {
+	char header[sizeof(ReplayRecorder::magic)] = {};
+	std::uint64_t eventCount = 0;
+
+	if (!in.read(header, sizeof(header)) ||
+		!std::equal(header, header + sizeof(header), ReplayRecorder::magic))
+		throw std::runtime_error("Not a replay log");
+
+	if (readUnsigned(in, 1) != ReplayRecorder::version)
+		throw std::runtime_error("Unsupported replay log version");
+
+	for (int event = in.get(); event != std::char_traits<char>::eof(); event = in.get()) {
+		if (event == static_cast<int>(ReplayEvent::Ticks)) {
+			const std::uint64_t ticks = readUnsigned(in, sizeof(std::uint64_t));
+
+			for (std::uint64_t tick = 0; tick < ticks; ++tick) timepiece.tick();
+		}
+		else if (event == static_cast<int>(ReplayEvent::AddTimepiece)) {
+			addOrreryTimepiece(timepiece, readString(in));
+		}
+		else if (event == static_cast<int>(ReplayEvent::AddClock)) {
+			const std::string timepieceLabel = readString(in);
+			const std::string clockLabel = readString(in);
+			const int h = readInt(in);
+			const int m = readInt(in);
+
+			emplaceClock(timepiece.getTimepiece(timepieceLabel), clockLabel, h, m);
+		}
+		else if (event == static_cast<int>(ReplayEvent::SetTime)) {
+			const std::string timepieceLabel = readString(in);
+			CelestialDayClock& clock = timepiece.getTimepiece(timepieceLabel).getClock(readString(in));
+
+			clock.setHours(readInt(in));
+			clock.setMinutesDigit1(readInt(in));
+			clock.setMinutesDigit2(readInt(in));
+			clock.setSecondsDigit1(readInt(in));
+			clock.setSecondsDigit2(readInt(in));
+		}
+		else if (event == static_cast<int>(ReplayEvent::State)) {
+			const std::uint64_t orreryCount = readUnsigned(in, sizeof(std::uint32_t));
+
+			for (std::uint64_t orreryIndex = 0; orreryIndex < orreryCount; ++orreryIndex) {
+				OrreryTimepiece& orrery = addOrreryTimepiece(timepiece, readString(in));
+				const std::uint64_t clockCount = readUnsigned(in, sizeof(std::uint32_t));
+
+				for (std::uint64_t index = 0; index < clockCount; ++index) {
+					const std::string clockLabel = readString(in);
+					const int h = readInt(in);
+					const int m = readInt(in);
+
+					emplaceClock(orrery, clockLabel, h, m).setSecondsOfDay(readInt(in));
+				}
+			}
+		}
+		else if (event == static_cast<int>(ReplayEvent::RemoveTimepiece)) {
+			delete timepiece.remove(readString(in));
+		}
+		else if (event == static_cast<int>(ReplayEvent::SetDayPhases)) {
+			const std::uint64_t phaseCount = readUnsigned(in, sizeof(std::uint32_t));
+			std::vector<std::uint32_t> phases;
+
+			if (phaseCount != timepiece.getSize()) throw std::runtime_error("Corrupt day phases in replay log");
+
+			phases.reserve(phaseCount);
+
+			for (std::uint64_t index = 0; index < phaseCount; ++index)
+				phases.push_back(static_cast<std::uint32_t>(readUnsigned(in, sizeof(std::uint32_t))));
+
+			timepiece.setDayPhases(phases);
+		}
+		else if (event == static_cast<int>(ReplayEvent::Reprofile)) {
+			const int fromHours = readInt(in);
+			const int fromMinutes = readInt(in);
+			const int toHours = readInt(in);
+			const int toMinutes = readInt(in);
+
+			timepiece.reprofile(DayProfile::fromBodyMaximums(fromHours, fromMinutes),
+				DayProfile::fromBodyMaximums(toHours, toMinutes));
+		}
+		else if (event == static_cast<int>(ReplayEvent::Rewind)) {
+			const std::string timepieceLabel = readString(in);
+			CelestialDayClock& clock = timepiece.getTimepiece(timepieceLabel).getClock(readString(in));
+
+			clock.rewind(readUnsigned(in, sizeof(std::uint64_t)));
+		}
+		else {
+			throw std::runtime_error("Unknown replay event " + std::to_string(event));
+		}
+
+		++eventCount;
+	}
+
+	return eventCount;
+}
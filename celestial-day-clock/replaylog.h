@@ -0,0 +1,76 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include "galactictimepiece.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class ReplayEvent : std::uint8_t {
+	Ticks = 1,
+	AddTimepiece,
+	AddClock,
+	SetTime,
+	State,
+	RemoveTimepiece,
+	SetDayPhases,
+	Reprofile,
+	Rewind
+};
+
+/* Applies mutations to a GalacticTimepiece while appending them and its ticks to a binary replay
+   log, coalescing consecutive ticks into a single event. The log starts with the galaxy's state
+   when recording began, with derived clocks stored as plain clocks at their current times. Only
+   mutations made through the recorder are logged, so a galaxy being recorded must not be changed
+   directly */
+class ReplayRecorder {
+public:
+	static constexpr char magic[4] = { 'C', 'D', 'C', 'R' };
+	static constexpr std::uint8_t version = 2;
+
+	ReplayRecorder(GalacticTimepiece& timepiece, std::ostream& out);
+
+	~ReplayRecorder();
+
+	ReplayRecorder(const ReplayRecorder&) = delete;
+
+	ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+	void addTimepiece(const std::string& label);
+
+	void addClock(const std::string& timepieceLabel, const std::string& clockLabel, int h, int m);
+
+	void setTime(const std::string& timepieceLabel, const std::string& clockLabel,
+		int hours, int minutesDigit1, int minutesDigit2, int secondsDigit1, int secondsDigit2);
+
+	void removeTimepiece(const std::string& label);
+
+	void setDayPhases(const std::vector<std::uint32_t>& phases);
+
+	// Day profile IDs differ between processes, so profiles are identified by their body maximums
+	size_t reprofile(int fromHours, int fromMinutes, int toHours, int toMinutes);
+
+	void rewind(const std::string& timepieceLabel, const std::string& clockLabel, std::uint64_t seconds);
+
+	void flush();
+
+private:
+	GalacticTimepiece& timepiece;
+	std::ostream& out;
+	std::uint64_t pendingTicks = 0;
+	size_t listenerId;
+
+	void flushTicks();
+
+	void writeState();
+};
+
+// Rebuilds a GalacticTimepiece by applying every event of a replay log in order
+class ReplayPlayer {
+public:
+	static std::uint64_t replay(std::istream& in, GalacticTimepiece& timepiece);
+};
+
+#endif
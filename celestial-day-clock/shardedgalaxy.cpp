@@ -0,0 +1,503 @@
+#include "shardedgalaxy.h"
+
+double ShardTickLatency::getMeanNanoseconds() const {
+	return tickCount == 0 ? 0.0 : static_cast<double>(totalNanoseconds) / static_cast<double>(tickCount);
+}
+
+#ifdef __linux__
+#include "galactictimepiece.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void appendUnsigned(std::string& message, std::uint64_t value, int byteCount) {
+	for (int byte = 0; byte < byteCount; ++byte) {
+		message.push_back(static_cast<char>(value & 0xFF));
+		value >>= 8;
+	}
+}
+
+static void appendInt(std::string& message, int value) {
+	appendUnsigned(message, static_cast<std::uint32_t>(value), sizeof(std::uint32_t));
+}
+
+static void appendString(std::string& message, std::string_view value) {
+	appendUnsigned(message, value.size(), sizeof(std::uint32_t));
+	message.append(value);
+}
+
+static std::uint64_t readUnsigned(const std::string& message, size_t& offset, int byteCount) {
+	std::uint64_t value = 0;
+
+	if (message.size() - offset < static_cast<size_t>(byteCount)) throw std::runtime_error("Truncated shard message");
+
+	for (int byte = 0; byte < byteCount; ++byte)
+		value |= static_cast<std::uint64_t>(static_cast<unsigned char>(message[offset++])) << (byte * 8);
+
+	return value;
+}
+
+static int readInt(const std::string& message, size_t& offset) {
+	return static_cast<int>(static_cast<std::uint32_t>(readUnsigned(message, offset, sizeof(std::uint32_t))));
+}
+
+static std::string readString(const std::string& message, size_t& offset) {
+	const size_t size = readUnsigned(message, offset, sizeof(std::uint32_t));
+
+	if (message.size() - offset < size) throw std::runtime_error("Truncated shard message");
+
+	offset += size;
+
+	return message.substr(offset - size, size);
+}
+
+static void sendMessage(int socket, const std::string& message) {
+	std::string frame;
+
+	appendUnsigned(frame, message.size(), sizeof(std::uint32_t));
+	frame += message;
+
+	for (size_t offset = 0; offset < frame.size();) {
+		const ssize_t sent = ::send(socket, frame.data() + offset, frame.size() - offset, MSG_NOSIGNAL);
+
+		if (sent < 0 && errno == EINTR) continue;
+
+		if (sent <= 0) throw std::runtime_error("Failed to send shard message");
+
+		offset += static_cast<size_t>(sent);
+	}
+}
+
+// Returns false if the peer closed the socket before the message began
+static bool receiveBytes(int socket, char* bytes, size_t size, bool isMessageStart) {
+	for (size_t offset = 0; offset < size;) {
+		const ssize_t received = ::recv(socket, bytes + offset, size - offset, 0);
+
+		if (received < 0 && errno == EINTR) continue;
+
+		if (received == 0 && offset == 0 && isMessageStart) return false;
+
+		if (received <= 0) throw std::runtime_error("Failed to receive shard message");
+
+		offset += static_cast<size_t>(received);
+	}
+
+	return true;
+}
+
+static bool receiveMessage(int socket, std::string& message) {
+	char header[sizeof(std::uint32_t)];
+	size_t offset = 0;
+
+	if (!receiveBytes(socket, header, sizeof(header), true)) return false;
+
+	message.assign(header, sizeof(header));
+	message.resize(readUnsigned(message, offset, sizeof(std::uint32_t)));
+
+	if (!message.empty()) receiveBytes(socket, message.data(), message.size(), false);
+
+	return true;
+}
+
+// Views are synced first, so every clock travels as its current time and day profile
+static void appendOrrery(std::string& message, const OrreryTimepiece& timepiece) {
+	timepiece.syncViews();
+	appendUnsigned(message, timepiece.getSize(), sizeof(std::uint32_t));
+
+	for (size_t index = 0; index < timepiece.getSize(); ++index) {
+		const CelestialDayClock& clock = timepiece.getClockAt(index);
+
+		appendString(message, timepiece.getLabelAt(index));
+		appendInt(message, clock.getProfile().bodyMaxHours);
+		appendInt(message, clock.getProfile().bodyMaxMinutes);
+		appendInt(message, clock.getSecondsOfDay());
+	}
+}
+
+static OrreryTimepiece* readOrrery(const std::string& message, size_t& offset) {
+	std::unique_ptr<OrreryTimepiece> timepiece = std::make_unique<OrreryTimepiece>();
+	const size_t clockCount = readUnsigned(message, offset, sizeof(std::uint32_t));
+
+	for (size_t index = 0; index < clockCount; ++index) {
+		const std::string label = readString(message, offset);
+		const int bodyMaxHours = readInt(message, offset);
+		const int bodyMaxMinutes = readInt(message, offset);
+		const int secondsOfDay = readInt(message, offset);
+		CelestialDayClock* const clock = timepiece->emplace(label, bodyMaxHours, bodyMaxMinutes);
+
+		if (clock != nullptr) clock->setSecondsOfDay(secondsOfDay);
+	}
+
+	return timepiece.release();
+}
+
+ShardedGalaxy::ShardedGalaxy(size_t shardCount) {
+	if (shardCount == 0) throw std::invalid_argument("A sharded galaxy needs at least one shard");
+
+	for (size_t shardIndex = 0; shardIndex < shardCount; ++shardIndex) {
+		int sockets[2] = { -1, -1 };
+
+		if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) < 0) {
+			stop();
+			throw std::runtime_error("Failed to create shard socket pair");
+		}
+
+		const pid_t processId = fork();
+
+		if (processId == 0) {
+			// A shard keeps only its own end of its own socket pair
+			for (const Shard& shard : shards) close(shard.socket);
+
+			close(sockets[0]);
+			serve(sockets[1]);
+		}
+
+		close(sockets[1]);
+
+		if (processId < 0) {
+			close(sockets[0]);
+			stop();
+			throw std::runtime_error("Failed to fork shard process");
+		}
+
+		shards.push_back({ processId, sockets[0], 0 });
+	}
+}
+
+ShardedGalaxy::~ShardedGalaxy() { stop(); }
+
+size_t ShardedGalaxy::getSize() const {
+	size_t size = 0;
+
+	for (const Shard& shard : shards) size += shard.size;
+
+	return size;
+}
+
+void ShardedGalaxy::add(const std::string& label, const OrreryTimepiece& timepiece) {
+	const auto leastLoaded = std::min_element(shards.begin(), shards.end(),
+		[](const Shard& first, const Shard& second) { return first.size < second.size; });
+
+	add(label, timepiece, static_cast<size_t>(leastLoaded - shards.begin()));
+}
+
+void ShardedGalaxy::add(const std::string& label, const OrreryTimepiece& timepiece, size_t shardIndex) {
+	checkFailed();
+
+	if (shardIndex >= shards.size()) throw std::out_of_range("Shard index out of range");
+
+	if (placementIndices.count(label) > 0) {
+		std::cerr << "Timepiece with label " << label << " already exists" << std::endl;
+		return;
+	}
+
+	std::string message(1, static_cast<char>(ShardCommand::Add));
+
+	appendString(message, label);
+	appendOrrery(message, timepiece);
+	request(shardIndex, message);
+	placementIndices.emplace(label, placements.size());
+	placements.push_back({ label, shardIndex, timepiece.getSize() });
+}
+
+void ShardedGalaxy::tick() {
+	const std::string message(1, static_cast<char>(ShardCommand::Tick));
+	const auto start = std::chrono::steady_clock::now();
+
+	// Every shard ticks concurrently, and the barrier closes when the slowest one replies
+	broadcast(message);
+
+	const std::uint64_t nanoseconds = static_cast<std::uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+	++tickCount;
+	++tickLatency.tickCount;
+	tickLatency.lastNanoseconds = nanoseconds;
+	tickLatency.maxNanoseconds = std::max(tickLatency.maxNanoseconds, nanoseconds);
+	tickLatency.totalNanoseconds += nanoseconds;
+}
+
+void ShardedGalaxy::snapshot(ClockSnapshot& clockSnapshot) {
+	const std::string message(1, static_cast<char>(ShardCommand::Snapshot));
+	std::vector<std::vector<std::pair<DayProfile::Id, int>>> clocks(placements.size());
+
+	// Day profiles are interned per process, so shards send body maximums rather than profile IDs
+	for (const std::string& reply : broadcast(message)) {
+		size_t offset = 0;
+
+		while (offset < reply.size()) {
+			std::vector<std::pair<DayProfile::Id, int>>& orreryClocks = clocks.at(placementIndices.at(readString(reply, offset)));
+			const size_t clockCount = readUnsigned(reply, offset, sizeof(std::uint32_t));
+
+			for (size_t index = 0; index < clockCount; ++index) {
+				const int bodyMaxHours = readInt(reply, offset);
+				const int bodyMaxMinutes = readInt(reply, offset);
+
+				orreryClocks.emplace_back(DayProfile::fromBodyMaximums(bodyMaxHours, bodyMaxMinutes), readInt(reply, offset));
+			}
+		}
+	}
+
+	clockSnapshot.tick = tickCount;
+	clockSnapshot.profileIds.clear();
+	clockSnapshot.secondsOfDay.clear();
+
+	for (const std::vector<std::pair<DayProfile::Id, int>>& orreryClocks : clocks) {
+		for (const auto& [profileId, secondsOfDay] : orreryClocks) {
+			clockSnapshot.profileIds.push_back(profileId);
+			clockSnapshot.secondsOfDay.push_back(secondsOfDay);
+		}
+	}
+}
+
+std::vector<std::string> ShardedGalaxy::getTimesMilitary() { return collectTimes(ShardCommand::TimesMilitary); }
+
+std::vector<std::string> ShardedGalaxy::getTimes() { return collectTimes(ShardCommand::Times); }
+
+size_t ShardedGalaxy::rebalance() {
+	const std::string message(1, static_cast<char>(ShardCommand::Size));
+	size_t moveCount = 0;
+
+	checkFailed();
+
+	for (size_t shardIndex = 0; shardIndex < shards.size(); ++shardIndex) request(shardIndex, message);
+
+	while (true) {
+		const auto [smallest, largest] = std::minmax_element(shards.begin(), shards.end(),
+			[](const Shard& first, const Shard& second) { return first.size < second.size; });
+		const size_t gap = largest->size - smallest->size;
+		const size_t largestIndex = static_cast<size_t>(largest - shards.begin());
+		size_t bestIndex = placements.size();
+
+		// Moving an orrery smaller than the gap always narrows it, so the loop ends
+		for (size_t index = 0; index < placements.size(); ++index) {
+			const Placement& placement = placements[index];
+
+			if (placement.shardIndex != largestIndex || placement.size == 0 || placement.size >= gap) continue;
+
+			if (bestIndex == placements.size() || std::max(placement.size, gap - placement.size) <
+				std::max(placements[bestIndex].size, gap - placements[bestIndex].size))
+				bestIndex = index;
+		}
+
+		if (bestIndex == placements.size()) return moveCount;
+
+		move(bestIndex, static_cast<size_t>(smallest - shards.begin()));
+		++moveCount;
+	}
+}
+
+void ShardedGalaxy::send(size_t shardIndex, const std::string& message) {
+	sendMessage(shards.at(shardIndex).socket, message);
+}
+
+// Every reply starts with the shard's size after handling the request
+std::string ShardedGalaxy::receive(size_t shardIndex) {
+	Shard& shard = shards.at(shardIndex);
+	std::string reply;
+	size_t offset = 0;
+
+	if (!receiveMessage(shard.socket, reply))
+		throw std::runtime_error("Shard " + std::to_string(shardIndex) + " stopped");
+
+	shard.size = readUnsigned(reply, offset, sizeof(std::uint32_t));
+
+	return reply.substr(offset);
+}
+
+std::string ShardedGalaxy::request(size_t shardIndex, const std::string& message) {
+	checkFailed();
+
+	try {
+		send(shardIndex, message);
+
+		return receive(shardIndex);
+	}
+	catch (const std::runtime_error&) {
+		fail();
+		throw;
+	}
+}
+
+// A shard failing mid-barrier leaves the other shards' replies unread, so all of them are stopped
+std::vector<std::string> ShardedGalaxy::broadcast(const std::string& message) {
+	std::vector<std::string> replies;
+
+	checkFailed();
+	replies.reserve(shards.size());
+
+	try {
+		for (size_t shardIndex = 0; shardIndex < shards.size(); ++shardIndex) send(shardIndex, message);
+
+		for (size_t shardIndex = 0; shardIndex < shards.size(); ++shardIndex) replies.push_back(receive(shardIndex));
+	}
+	catch (const std::runtime_error&) {
+		fail();
+		throw;
+	}
+
+	return replies;
+}
+
+void ShardedGalaxy::checkFailed() const {
+	if (hasFailed) throw std::runtime_error("Sharded galaxy stopped after a shard failed");
+}
+
+void ShardedGalaxy::fail() {
+	hasFailed = true;
+	stop();
+}
+
+void ShardedGalaxy::move(size_t placementIndex, size_t shardIndex) {
+	Placement& placement = placements.at(placementIndex);
+	std::string message(1, static_cast<char>(ShardCommand::Remove));
+
+	appendString(message, placement.label);
+
+	const std::string timepiece = request(placement.shardIndex, message);
+
+	message.assign(1, static_cast<char>(ShardCommand::Add));
+	appendString(message, placement.label);
+	message += timepiece;
+	request(shardIndex, message);
+	placement.shardIndex = shardIndex;
+}
+
+std::vector<std::string> ShardedGalaxy::collectTimes(ShardCommand command) {
+	const std::string message(1, static_cast<char>(command));
+	std::vector<std::vector<std::string>> orreryTimes(placements.size());
+	std::vector<std::string> times;
+
+	for (const std::string& reply : broadcast(message)) {
+		size_t offset = 0;
+
+		while (offset < reply.size()) {
+			std::vector<std::string>& lines = orreryTimes.at(placementIndices.at(readString(reply, offset)));
+			const size_t lineCount = readUnsigned(reply, offset, sizeof(std::uint32_t));
+
+			for (size_t index = 0; index < lineCount; ++index) lines.push_back(readString(reply, offset));
+		}
+	}
+
+	for (std::vector<std::string>& lines : orreryTimes)
+		std::move(lines.begin(), lines.end(), std::back_inserter(times));
+
+	return times;
+}
+
+void ShardedGalaxy::stop() {
+	const std::string message(1, static_cast<char>(ShardCommand::Stop));
+
+	for (Shard& shard : shards) {
+		int status = 0;
+
+		try {
+			sendMessage(shard.socket, message);
+		}
+		catch (const std::runtime_error&) {
+			// A shard that already exited is reaped below
+		}
+
+		close(shard.socket);
+		waitpid(shard.processId, &status, 0);
+	}
+
+	shards.clear();
+}
+
+// The shard's side of the socket pair; it never returns
+void ShardedGalaxy::serve(int socket) {
+	int exitCode = 0;
+
+	try {
+		GalacticTimepiece timepiece;
+		std::string message;
+		std::string payload;
+		std::string reply;
+
+		timepiece.setTickThreadCount(1);
+
+		while (receiveMessage(socket, message)) {
+			size_t offset = 0;
+			const ShardCommand command = static_cast<ShardCommand>(readUnsigned(message, offset, 1));
+
+			if (command == ShardCommand::Stop) break;
+
+			payload.clear();
+
+			switch (command) {
+			case ShardCommand::Add: {
+				const std::string label = readString(message, offset);
+				std::unique_ptr<OrreryTimepiece> orrery(readOrrery(message, offset));
+
+				if (timepiece.add(label, orrery.get())) orrery.release();
+				break;
+			}
+			case ShardCommand::Remove: {
+				const std::unique_ptr<OrreryTimepiece> removed(timepiece.remove(readString(message, offset)));
+
+				appendOrrery(payload, *removed);
+				break;
+			}
+			case ShardCommand::Tick:
+				timepiece.tick();
+				break;
+			case ShardCommand::Size:
+				break;
+			case ShardCommand::Snapshot:
+				for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+					const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+					orreryTimepiece.syncViews();
+					appendString(payload, timepiece.getLabelAt(orreryIndex));
+					appendUnsigned(payload, orreryTimepiece.getSize(), sizeof(std::uint32_t));
+
+					for (size_t index = 0; index < orreryTimepiece.getSize(); ++index) {
+						const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+
+						appendInt(payload, clock.getProfile().bodyMaxHours);
+						appendInt(payload, clock.getProfile().bodyMaxMinutes);
+						appendInt(payload, clock.getSecondsOfDay());
+					}
+				}
+				break;
+			case ShardCommand::TimesMilitary:
+			case ShardCommand::Times:
+				for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+					const std::string label(timepiece.getLabelAt(orreryIndex));
+					OrreryTimepiece& orreryTimepiece = timepiece.getTimepiece(label);
+					const std::vector<std::string> times = command == ShardCommand::Times ?
+						orreryTimepiece.getTimes() : orreryTimepiece.getTimesMilitary();
+
+					appendString(payload, label);
+					appendUnsigned(payload, times.size(), sizeof(std::uint32_t));
+
+					for (const std::string& time : times) appendString(payload, label + time);
+				}
+				break;
+			default:
+				throw std::runtime_error("Unknown shard command");
+			}
+
+			reply.clear();
+			appendUnsigned(reply, timepiece.getSize(), sizeof(std::uint32_t));
+			reply += payload;
+			sendMessage(socket, reply);
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Exception in shard: " << e.what() << std::endl;
+		exitCode = 1;
+	}
+
+	close(socket);
+	_exit(exitCode);
+}
+#endif
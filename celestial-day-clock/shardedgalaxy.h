@@ -0,0 +1,127 @@
+#ifndef SHARDED_GALAXY_H
+#define SHARDED_GALAXY_H
+
+#include "clocksnapshot.h"
+#include "orrerytimepiece.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// End-to-end latency of a sharded galaxy's ticks, from broadcasting the barrier to the last shard's reply
+struct ShardTickLatency {
+	std::uint64_t tickCount = 0;
+	std::uint64_t lastNanoseconds = 0;
+	std::uint64_t maxNanoseconds = 0;
+	std::uint64_t totalNanoseconds = 0;
+
+	double getMeanNanoseconds() const;
+};
+
+enum class ShardCommand : std::uint8_t {
+	Add = 1,
+	Remove,
+	Tick,
+	Size,
+	Snapshot,
+	TimesMilitary,
+	Times,
+	Stop
+};
+
+/* Runs a galaxy's orreries in worker processes forked at construction, each owning a galactic
+   timepiece of its own and talking to the coordinator over a Unix socket pair. A tick is a barrier:
+   the coordinator sends it to every shard and returns once all of them have ticked. Orreries are
+   copied into the least loaded shard when added, and rebalance moves them between shards by the
+   sizes the shards report. Derived clocks arrive in a shard as ticked clocks at their current time.
+   If a shard fails to take or answer a request, every shard is stopped, since the others may still
+   hold unread replies, and the galaxy throws on every later request.
+   Shards are forked before any orrery is added, so construct it before starting other threads.
+   Linux only */
+class ShardedGalaxy {
+public:
+	explicit ShardedGalaxy(size_t shardCount);
+
+	~ShardedGalaxy();
+
+	ShardedGalaxy(const ShardedGalaxy&) = delete;
+
+	ShardedGalaxy& operator=(const ShardedGalaxy&) = delete;
+
+	size_t getShardCount() const { return shards.size(); }
+
+	size_t getShardSize(size_t shardIndex) const { return shards.at(shardIndex).size; }
+
+	int getShardProcessId(size_t shardIndex) const { return shards.at(shardIndex).processId; }
+
+	bool isFailed() const { return hasFailed; }
+
+	size_t getSize() const;
+
+	size_t getTimepieceCount() const { return placements.size(); }
+
+	const std::string& getLabelAt(size_t index) const { return placements.at(index).label; }
+
+	size_t getShardAt(size_t index) const { return placements.at(index).shardIndex; }
+
+	std::uint64_t getTickCount() const { return tickCount; }
+
+	const ShardTickLatency& getTickLatency() const { return tickLatency; }
+
+	void add(const std::string& label, const OrreryTimepiece& timepiece);
+
+	void add(const std::string& label, const OrreryTimepiece& timepiece, size_t shardIndex);
+
+	void tick();
+
+	void snapshot(ClockSnapshot& clockSnapshot);
+
+	std::vector<std::string> getTimesMilitary();
+
+	std::vector<std::string> getTimes();
+
+	size_t rebalance();
+
+private:
+	struct Shard {
+		int processId = -1;
+		int socket = -1;
+		size_t size = 0;
+	};
+
+	struct Placement {
+		std::string label;
+		size_t shardIndex = 0;
+		size_t size = 0;
+	};
+
+	std::vector<Shard> shards;
+	std::vector<Placement> placements;
+	std::unordered_map<std::string, size_t> placementIndices;
+	ShardTickLatency tickLatency;
+	std::uint64_t tickCount = 0;
+	bool hasFailed = false;
+
+	void send(size_t shardIndex, const std::string& request);
+
+	std::string receive(size_t shardIndex);
+
+	std::string request(size_t shardIndex, const std::string& message);
+
+	std::vector<std::string> broadcast(const std::string& message);
+
+	void checkFailed() const;
+
+	void fail();
+
+	void move(size_t placementIndex, size_t shardIndex);
+
+	std::vector<std::string> collectTimes(ShardCommand command);
+
+	void stop();
+
+	[[noreturn]] static void serve(int socket);
+};
+
+#endif
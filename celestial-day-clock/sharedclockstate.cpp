@@ -0,0 +1,286 @@
+#include "sharedclockstate.h"
+#include "cacheline.h"
+
+#ifdef __linux__
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr char sharedClockMagic[4] = { 'C', 'D', 'C', 'S' };
+static constexpr size_t headerSize = (sizeof(SharedClockHeader) + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+
+static size_t getLayoutsOffset(size_t clockCapacity) {
+	return headerSize + (clockCapacity * sizeof(std::int32_t) + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+}
+
+static size_t getLabelsOffset(size_t clockCapacity) {
+	return getLayoutsOffset(clockCapacity) + clockCapacity * sizeof(SharedClockLayout);
+}
+
+static size_t getSegmentSize(size_t clockCapacity, size_t labelCapacity) {
+	return getLabelsOffset(clockCapacity) + labelCapacity;
+}
+
+ClockStatePublisher::ClockStatePublisher(GalacticTimepiece& timepiece, const std::string& name,
+	size_t clockCapacity) : timepiece(timepiece), name(name) {
+	if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos)
+		throw std::invalid_argument("Invalid shared memory name " + name);
+
+	if (clockCapacity == 0) clockCapacity = std::max(2 * timepiece.getSize(), minClockCapacity);
+
+	if (clockCapacity > std::numeric_limits<std::uint32_t>::max() / labelBytesPerClock)
+		throw std::length_error("Shared clock capacity exceeded");
+
+	const size_t labelCapacity = clockCapacity * labelBytesPerClock;
+	const int fileDescriptor = shm_open(name.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+
+	if (fileDescriptor < 0) throw std::runtime_error("Failed to create shared memory segment " + name);
+
+	segmentSize = getSegmentSize(clockCapacity, labelCapacity);
+
+	void* const mapping = ftruncate(fileDescriptor, static_cast<off_t>(segmentSize)) < 0 ? MAP_FAILED :
+		mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+	close(fileDescriptor);
+
+	if (mapping == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		throw std::runtime_error("Failed to map shared memory segment " + name);
+	}
+
+	header = new (mapping) SharedClockHeader();
+	header->version = SharedClockHeader::currentVersion;
+	header->clockCapacity = static_cast<std::uint32_t>(clockCapacity);
+	header->labelCapacity = static_cast<std::uint32_t>(labelCapacity);
+	timepiece.snapshot(snapshot);
+	write(true);
+	std::memcpy(header->magic, sharedClockMagic, sizeof(sharedClockMagic));
+
+	// Copying every clock's seconds of day into the segment adds one pass over the galaxy to each tick
+	tickListenerId = timepiece.addTickListener([this](std::uint64_t tick) {
+		std::lock_guard<std::mutex> lock(mtx);
+
+		capture(tick);
+		write(this->timepiece.getRevision() != publishedRevision);
+		});
+}
+
+ClockStatePublisher::~ClockStatePublisher() {
+	timepiece.removeTickListener(tickListenerId);
+	munmap(header, segmentSize);
+	shm_unlink(name.c_str());
+}
+
+void ClockStatePublisher::publish() {
+	ClockSnapshot clockSnapshot;
+
+	timepiece.snapshot(clockSnapshot);
+
+	std::lock_guard<std::mutex> lock(mtx);
+
+	snapshot = std::move(clockSnapshot);
+	write(timepiece.getRevision() != publishedRevision);
+}
+
+void ClockStatePublisher::capture(std::uint64_t tick) {
+	snapshot.tick = tick;
+	snapshot.profileIds.clear();
+	snapshot.secondsOfDay.clear();
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+		orreryTimepiece.syncViews();
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index) {
+			const CelestialDayClock& clock = orreryTimepiece.getClockAt(index);
+
+			snapshot.profileIds.push_back(clock.getProfileId());
+			snapshot.secondsOfDay.push_back(clock.getSecondsOfDay());
+		}
+	}
+}
+
+void ClockStatePublisher::write(bool isLayoutChanged) {
+	char* const base = reinterpret_cast<char*>(header);
+	std::int32_t* const secondsOfDay = reinterpret_cast<std::int32_t*>(base + headerSize);
+	const std::uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+
+	header->sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	if (isLayoutChanged) {
+		SharedClockLayout* const layouts = reinterpret_cast<SharedClockLayout*>(base + getLayoutsOffset(header->clockCapacity));
+		char* const labels = base + getLabelsOffset(header->clockCapacity);
+		size_t clockCount = 0;
+		size_t labelOffset = 0;
+		bool isFull = false;
+
+		for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount() && !isFull; ++orreryIndex) {
+			const std::string_view orreryLabel = timepiece.getLabelAt(orreryIndex);
+			const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+
+			for (size_t index = 0; index < orreryTimepiece.getSize() && !isFull; ++index) {
+				const std::string_view clockLabel = orreryTimepiece.getLabelAt(index);
+				const DayProfile& profile = orreryTimepiece.getClockAt(index).getProfile();
+				const size_t labelSize = orreryLabel.size() + clockLabel.size();
+
+				isFull = clockCount == header->clockCapacity || labelSize > header->labelCapacity - labelOffset;
+
+				if (isFull) break;
+
+				std::memcpy(labels + labelOffset, orreryLabel.data(), orreryLabel.size());
+				std::memcpy(labels + labelOffset + orreryLabel.size(), clockLabel.data(), clockLabel.size());
+				layouts[clockCount++] = { static_cast<std::uint32_t>(labelOffset), static_cast<std::uint32_t>(labelSize),
+					profile.bodyMaxHours, profile.bodyMaxMinutes };
+				labelOffset += labelSize;
+			}
+		}
+
+		publishedRevision = timepiece.getRevision();
+		header->revision = publishedRevision;
+		header->clockCount = static_cast<std::uint32_t>(clockCount);
+	}
+
+	std::copy_n(snapshot.secondsOfDay.begin(), std::min<size_t>(header->clockCount, snapshot.getSize()), secondsOfDay);
+	header->tick = snapshot.tick;
+	header->totalClockCount = static_cast<std::uint32_t>(snapshot.getSize());
+	header->sequence.store(sequence + 2, std::memory_order_release);
+	++publishCount;
+}
+
+ClockStateReader::ClockStateReader(const std::string& name) {
+	const int fileDescriptor = shm_open(name.c_str(), O_RDONLY, 0);
+	struct stat status = {};
+
+	if (fileDescriptor < 0) throw std::runtime_error("Failed to open shared memory segment " + name);
+
+	void* const mapping = fstat(fileDescriptor, &status) < 0 || static_cast<size_t>(status.st_size) < headerSize ?
+		MAP_FAILED : mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+
+	close(fileDescriptor);
+
+	if (mapping == MAP_FAILED) throw std::runtime_error("Failed to map shared memory segment " + name);
+
+	header = static_cast<const SharedClockHeader*>(mapping);
+	segmentSize = static_cast<size_t>(status.st_size);
+
+	if (std::memcmp(header->magic, sharedClockMagic, sizeof(sharedClockMagic)) != 0 ||
+		header->version != SharedClockHeader::currentVersion ||
+		getSegmentSize(header->clockCapacity, header->labelCapacity) > segmentSize) {
+		munmap(const_cast<SharedClockHeader*>(header), segmentSize);
+		throw std::runtime_error("Shared memory segment " + name + " does not hold clock state");
+	}
+}
+
+ClockStateReader::~ClockStateReader() { munmap(const_cast<SharedClockHeader*>(header), segmentSize); }
+
+std::string_view ClockStateReader::getLabelAt(size_t index) const {
+	return std::string_view(labels).substr(layouts.at(index).labelOffset, layouts[index].labelSize);
+}
+
+void ClockStateReader::read(ClockSnapshot& clockSnapshot) {
+	load();
+	clockSnapshot.tick = tick;
+	clockSnapshot.profileIds.clear();
+	clockSnapshot.secondsOfDay.assign(secondsOfDay.begin(), secondsOfDay.end());
+
+	for (const CelestialDayClock& clock : clocks) clockSnapshot.profileIds.push_back(clock.getProfileId());
+}
+
+void ClockStateReader::readTimesMilitary(std::vector<std::string>& times) { readTimes(times, true); }
+
+void ClockStateReader::readTimes(std::vector<std::string>& times) { readTimes(times, false); }
+
+void ClockStateReader::load() {
+	const char* const base = reinterpret_cast<const char*>(header);
+	const size_t clockCapacity = header->clockCapacity;
+	const size_t labelCapacity = header->labelCapacity;
+	std::uint64_t currentRevision = 0;
+	std::uint64_t currentTick = 0;
+	size_t currentTotalSize = 0;
+	bool isLayoutChanged = false;
+	std::uint64_t waitedSequence = 0;
+	std::chrono::steady_clock::time_point waitStart;
+
+	while (true) {
+		const std::uint64_t sequence = header->sequence.load(std::memory_order_acquire);
+
+		// Only a write that never finishes keeps one odd sequence, as every new write advances it
+		if (sequence & 1) {
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+			if (sequence != waitedSequence) {
+				waitedSequence = sequence;
+				waitStart = now;
+			}
+			else if (now - waitStart > std::chrono::milliseconds(maxWriteWaitMilliseconds)) {
+				throw std::runtime_error("Shared clock state publisher stopped while writing");
+			}
+
+			std::this_thread::yield();
+			continue;
+		}
+
+		const size_t clockCount = std::min<size_t>(header->clockCount, clockCapacity);
+
+		currentRevision = header->revision;
+		currentTick = header->tick;
+		currentTotalSize = header->totalClockCount;
+		isLayoutChanged = !hasLayout || currentRevision != revision;
+		secondsOfDay.resize(clockCount);
+		std::memcpy(secondsOfDay.data(), base + headerSize, clockCount * sizeof(std::int32_t));
+
+		if (isLayoutChanged) {
+			layouts.resize(clockCount);
+			std::memcpy(layouts.data(), base + getLayoutsOffset(clockCapacity), clockCount * sizeof(SharedClockLayout));
+			labels.assign(base + getLabelsOffset(clockCapacity), labelCapacity);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (header->sequence.load(std::memory_order_relaxed) == sequence) break;
+	}
+
+	tick = currentTick;
+	totalSize = currentTotalSize;
+
+	if (!isLayoutChanged) return;
+
+	clocks.clear();
+	clocks.reserve(layouts.size());
+
+	for (const SharedClockLayout& layout : layouts) {
+		if (layout.labelOffset > labelCapacity || layout.labelSize > labelCapacity - layout.labelOffset)
+			throw std::runtime_error("Corrupt label in shared clock state");
+
+		clocks.emplace_back(layout.bodyMaxHours, layout.bodyMaxMinutes);
+	}
+
+	revision = currentRevision;
+	hasLayout = true;
+}
+
+void ClockStateReader::readTimes(std::vector<std::string>& times, bool isMilitary) {
+	char time[CelestialDayClock::maxTimeLength];
+
+	load();
+	times.resize(clocks.size());
+
+	for (size_t index = 0; index < clocks.size(); ++index) {
+		CelestialDayClock& clock = clocks[index];
+
+		clock.setSecondsOfDay(secondsOfDay[index]);
+		times[index].assign(getLabelAt(index));
+		times[index].append(time, isMilitary ? clock.formatTimeMilitary(time) : clock.formatTime(time));
+	}
+}
+#endif
@@ -0,0 +1,126 @@
+#ifndef SHARED_CLOCK_STATE_H
+#define SHARED_CLOCK_STATE_H
+
+#include "celestialdayclock.h"
+#include "clocksnapshot.h"
+#include "galactictimepiece.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* The header of a shared clock state segment. The sequence is odd while the publisher writes and
+   is advanced again once the write is complete, so readers retry any copy that overlapped a write.
+   Arrays of seconds of day, clock layouts and label bytes follow the header */
+struct SharedClockHeader {
+	static constexpr std::uint32_t currentVersion = 1;
+
+	char magic[4];
+	std::uint32_t version;
+	std::atomic<std::uint64_t> sequence;
+	std::uint64_t tick;
+	std::uint64_t revision;
+	std::uint32_t clockCount;
+	std::uint32_t totalClockCount;
+	std::uint32_t clockCapacity;
+	std::uint32_t labelCapacity;
+};
+
+// Where a published clock's label lives and which day profile it uses
+struct SharedClockLayout {
+	std::uint32_t labelOffset;
+	std::uint32_t labelSize;
+	std::int32_t bodyMaxHours;
+	std::int32_t bodyMaxMinutes;
+};
+
+/* Publishes a galactic timepiece's clock state into a POSIX shared memory segment after every
+   tick, so that any number of local processes can read it without ticking clocks of their own.
+   Ticks only rewrite seconds of day; labels and profiles are rewritten when the revision changes.
+   Clocks beyond the segment's capacity are left out and counted in totalClockCount. Linux only */
+class ClockStatePublisher {
+public:
+	static constexpr size_t minClockCapacity = 256;
+	static constexpr size_t labelBytesPerClock = 64;
+
+	ClockStatePublisher(GalacticTimepiece& timepiece, const std::string& name, size_t clockCapacity = 0);
+
+	~ClockStatePublisher();
+
+	ClockStatePublisher(const ClockStatePublisher&) = delete;
+
+	ClockStatePublisher& operator=(const ClockStatePublisher&) = delete;
+
+	const std::string& getName() const { return name; }
+
+	std::uint64_t getPublishCount() const { return publishCount; }
+
+	void publish();
+
+private:
+	GalacticTimepiece& timepiece;
+	std::string name;
+	ClockSnapshot snapshot;
+	std::mutex mtx;
+	SharedClockHeader* header = nullptr;
+	size_t segmentSize = 0;
+	size_t publishedRevision = 0;
+	size_t tickListenerId = 0;
+	std::uint64_t publishCount = 0;
+
+	void capture(std::uint64_t tick);
+
+	void write(bool isLayoutChanged);
+};
+
+/* Maps a shared clock state segment read-only and formats its times locally. Each read copies the
+   seconds of day under the segment's sequence without any system call, and copies labels and
+   profiles again only when the publisher's revision has changed. A read that finds one write in
+   progress for longer than maxWriteWaitMilliseconds throws, as its publisher has stopped mid-write */
+class ClockStateReader {
+public:
+	static constexpr int maxWriteWaitMilliseconds = 1000;
+
+	explicit ClockStateReader(const std::string& name);
+
+	~ClockStateReader();
+
+	ClockStateReader(const ClockStateReader&) = delete;
+
+	ClockStateReader& operator=(const ClockStateReader&) = delete;
+
+	size_t getSize() const { return clocks.size(); }
+
+	std::uint64_t getTick() const { return tick; }
+
+	size_t getTotalSize() const { return totalSize; }
+
+	std::string_view getLabelAt(size_t index) const;
+
+	void read(ClockSnapshot& clockSnapshot);
+
+	void readTimesMilitary(std::vector<std::string>& times);
+
+	void readTimes(std::vector<std::string>& times);
+
+private:
+	const SharedClockHeader* header = nullptr;
+	std::vector<CelestialDayClock> clocks;
+	std::vector<SharedClockLayout> layouts;
+	std::vector<std::int32_t> secondsOfDay;
+	std::string labels;
+	std::uint64_t tick = 0;
+	std::uint64_t revision = 0;
+	size_t totalSize = 0;
+	size_t segmentSize = 0;
+	bool hasLayout = false;
+
+	void load();
+
+	void readTimes(std::vector<std::string>& times, bool isMilitary);
+};
+
+#endif
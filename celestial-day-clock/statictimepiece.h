@@ -0,0 +1,184 @@
+#ifndef STATIC_TIMEPIECE_H
+#define STATIC_TIMEPIECE_H
+
+#include "celestialdayclock.h"
+#include "celestialtimepiece.h"
+#include "labelpool.h"
+#include "memoryusage.h"
+#include "tickplan.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* A timepiece that holds its children by value and dispatches to them at compile time. A static
+   orrery holds clocks and a static galaxy holds static orreries, so ticking a whole hierarchy
+   compiles into nested loops over contiguous children with the clock's tick inlined. Adding a child
+   may move its siblings, so references and tick plans into a static timepiece last only until then */
+template<class Child>
+class StaticTimepiece {
+public:
+	static constexpr bool isLeafParent = std::is_same_v<Child, CelestialDayClock>;
+
+	template<class... Args>
+	Child* add(const std::string& label, Args&&... args) {
+		const LabelPool::Id labelId = LabelPool::intern(label);
+
+		for (const std::pair<LabelPool::Id, Child>& child : children) {
+			if (child.first == labelId) return nullptr;
+		}
+
+		children.emplace_back(std::piecewise_construct, std::forward_as_tuple(labelId),
+			std::forward_as_tuple(std::forward<Args>(args)...));
+		++revision;
+
+		return &children.back().second;
+	}
+
+	void reserve(size_t childCount) {
+		children.reserve(childCount);
+		++revision;
+	}
+
+	size_t getChildCount() const { return children.size(); }
+
+	std::string_view getLabelAt(size_t index) const { return LabelPool::get(children[index].first); }
+
+	const Child& getChildAt(size_t index) const { return children[index].second; }
+
+	Child& getChildAt(size_t index) { return children[index].second; }
+
+	size_t getSize() const {
+		if constexpr (isLeafParent) {
+			return children.size();
+		}
+		else {
+			size_t size = 0;
+
+			for (const std::pair<LabelPool::Id, Child>& child : children) size += child.second.getSize();
+
+			return size;
+		}
+	}
+
+	size_t getRevision() const {
+		size_t totalRevision = revision;
+
+		if constexpr (!isLeafParent) {
+			for (const std::pair<LabelPool::Id, Child>& child : children) totalRevision += child.second.getRevision();
+		}
+
+		return totalRevision;
+	}
+
+	void tick() {
+		for (std::pair<LabelPool::Id, Child>& child : children) {
+			if constexpr (isLeafParent) child.second.CelestialDayClock::tick();
+			else child.second.tick();
+		}
+	}
+
+	void appendTimes(std::vector<std::string>& times, std::string& prefix, bool isMilitary) const {
+		const size_t prefixSize = prefix.size();
+
+		for (const std::pair<LabelPool::Id, Child>& child : children) {
+			prefix.append(LabelPool::get(child.first));
+
+			if constexpr (isLeafParent) {
+				char time[CelestialDayClock::maxTimeLength];
+				const size_t timeSize = isMilitary ? child.second.formatTimeMilitary(time) : child.second.formatTime(time);
+
+				times.emplace_back(prefix).append(time, timeSize);
+			}
+			else {
+				child.second.appendTimes(times, prefix, isMilitary);
+			}
+
+			prefix.resize(prefixSize);
+		}
+	}
+
+	std::vector<std::string> getTimesMilitary() const { return collectTimes(true); }
+
+	std::vector<std::string> getTimes() const { return collectTimes(false); }
+
+	// Children live inside this timepiece's vector, so only the unused capacity counts as container
+	MemoryUsage memoryUsage() const {
+		MemoryUsage usage;
+
+		usage.stateBytes = sizeof(StaticTimepiece);
+		usage.addVector(children);
+		usage.containerBytes -= children.size() * sizeof(Child);
+
+		for (const std::pair<LabelPool::Id, Child>& child : children) {
+			usage += child.second.memoryUsage();
+			usage.labelBytes += LabelPool::get(child.first).size();
+		}
+
+		return usage;
+	}
+
+	void compileTickPlan(TickPlan& plan) {
+		for (std::pair<LabelPool::Id, Child>& child : children) {
+			if constexpr (isLeafParent) {
+				CelestialDayClock* const clock = &child.second;
+
+				plan.addClocks(&clock, 1);
+			}
+			else {
+				child.second.compileTickPlan(plan);
+			}
+		}
+
+		plan.addBoundary();
+	}
+
+private:
+	std::vector<std::pair<LabelPool::Id, Child>> children;
+	size_t revision = 0;
+
+	std::vector<std::string> collectTimes(bool isMilitary) const {
+		std::vector<std::string> times;
+		std::string prefix;
+
+		times.reserve(getSize());
+		appendTimes(times, prefix, isMilitary);
+
+		return times;
+	}
+};
+
+using StaticOrrery = StaticTimepiece<CelestialDayClock>;
+
+using StaticGalaxy = StaticTimepiece<StaticOrrery>;
+
+// Exposes a static timepiece through the virtual CelestialTimepiece interface for existing callers
+template<class Timepiece>
+class StaticTimepieceAdapter : public CelestialTimepiece {
+public:
+	StaticTimepieceAdapter() = default;
+
+	explicit StaticTimepieceAdapter(Timepiece timepiece) : timepiece(std::move(timepiece)) {}
+
+	Timepiece& get() { return timepiece; }
+
+	const Timepiece& get() const { return timepiece; }
+
+	std::vector<std::string> getTimes() override { return timepiece.getTimes(); }
+
+	MemoryUsage memoryUsage() const override { return timepiece.memoryUsage(); }
+
+	size_t getRevision() const override { return timepiece.getRevision(); }
+
+	void compileTickPlan(TickPlan& plan) override { timepiece.compileTickPlan(plan); }
+
+	void tick() override { timepiece.tick(); }
+
+private:
+	Timepiece timepiece;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "terminalrenderer.h"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// Equal cells between two changes are rewritten rather than skipped when shorter than a cursor move
+static constexpr size_t maxRewrittenGap = 6;
+
+static char getCell(std::string_view text, size_t column) {
+	return column < text.size() ? text[column] : ' ';
+}
+
+#ifdef _WIN32
+// The console behind a file descriptor, or an invalid handle if the descriptor is closed or not a console
+static HANDLE getConsoleHandle(int fileDescriptor) {
+	if (fileDescriptor < 0) return INVALID_HANDLE_VALUE;
+
+	return reinterpret_cast<HANDLE>(_get_osfhandle(fileDescriptor));
+}
+#endif
+
+static void enableVirtualTerminal([[maybe_unused]] int fileDescriptor) {
+#ifdef _WIN32
+	const HANDLE console = getConsoleHandle(fileDescriptor);
+	DWORD mode = 0;
+
+	if (console != INVALID_HANDLE_VALUE && GetConsoleMode(console, &mode))
+		SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+}
+
+TerminalRenderer::TerminalRenderer(int fileDescriptor) : fileDescriptor(fileDescriptor) {
+	getTerminalSize(fileDescriptor, rows, columns);
+	screen.assign(rows, std::string());
+	enableVirtualTerminal(fileDescriptor);
+}
+
+TerminalRenderer::TerminalRenderer(int fileDescriptor, size_t rows, size_t columns)
+	: screen(rows), rows(rows), columns(columns), fileDescriptor(fileDescriptor) {
+	if (rows < 2 || columns == 0) throw std::invalid_argument("Terminal must have at least two rows and one column");
+
+	enableVirtualTerminal(fileDescriptor);
+}
+
+TerminalRenderer::~TerminalRenderer() {
+	if (!isCleared) return;
+
+	frame.clear();
+	moveCursor(rows - 1, 0);
+	frame += "\r\n\x1b[?25h";
+
+	try {
+		write(frame);
+	}
+	catch (const std::exception&) {}
+}
+
+void TerminalRenderer::draw(const std::vector<std::string>& lines) {
+	lineViews.assign(lines.begin(), lines.end());
+	drawLines(lineViews);
+}
+
+void TerminalRenderer::draw(const RenderedTimes& times) { drawLines(times.getLines()); }
+
+void TerminalRenderer::redraw() { isCleared = false; }
+
+void TerminalRenderer::getTerminalSize(int fileDescriptor, size_t& rows, size_t& columns) {
+	rows = defaultRows;
+	columns = defaultColumns;
+
+#ifdef _WIN32
+	CONSOLE_SCREEN_BUFFER_INFO info;
+
+	if (GetConsoleScreenBufferInfo(getConsoleHandle(fileDescriptor), &info)) {
+		rows = static_cast<size_t>(info.srWindow.Bottom - info.srWindow.Top + 1);
+		columns = static_cast<size_t>(info.srWindow.Right - info.srWindow.Left + 1);
+	}
+#else
+	winsize size = {};
+
+	if (fileDescriptor >= 0 && ioctl(fileDescriptor, TIOCGWINSZ, &size) == 0 && size.ws_row > 1 && size.ws_col > 0) {
+		rows = size.ws_row;
+		columns = size.ws_col;
+	}
+#endif
+}
+
+void TerminalRenderer::drawLines(const std::vector<std::string_view>& lines) {
+	const bool isPaged = lines.size() > rows;
+	const size_t contentRows = isPaged ? rows - 1 : rows;
+
+	frame.clear();
+
+	if (!isCleared) {
+		frame += "\x1b[?25l\x1b[2J";
+		std::fill(screen.begin(), screen.end(), std::string());
+		isCleared = true;
+	}
+
+	firstLine = isPaged ? std::min(firstLine, lines.size() - contentRows) : 0;
+
+	for (size_t rowIndex = 0; rowIndex < contentRows; ++rowIndex) {
+		const size_t line = firstLine + rowIndex;
+
+		drawRow(rowIndex, line < lines.size() ? lines[line] : std::string_view());
+	}
+
+	if (isPaged) {
+		const std::string status = "-- Lines " + std::to_string(firstLine + 1) + "-" +
+			std::to_string(firstLine + contentRows) + " of " + std::to_string(lines.size()) + " --";
+
+		drawRow(rows - 1, status);
+	}
+
+	write(frame);
+}
+
+void TerminalRenderer::drawRow(size_t rowIndex, std::string_view text) {
+	std::string& previous = screen[rowIndex];
+
+	text = text.substr(0, columns);
+	row.assign(text);
+	row.resize(std::max(text.size(), previous.size()), ' ');
+
+	for (size_t column = 0; column < row.size();) {
+		if (getCell(previous, column) == row[column]) {
+			++column;
+			continue;
+		}
+
+		size_t lastChanged = column;
+
+		for (size_t next = column + 1; next < row.size() && next - lastChanged <= maxRewrittenGap; ++next) {
+			if (getCell(previous, next) != row[next]) lastChanged = next;
+		}
+
+		moveCursor(rowIndex, column);
+		frame.append(row, column, lastChanged + 1 - column);
+		column = lastChanged + 1;
+	}
+
+	previous.assign(text);
+}
+
+void TerminalRenderer::moveCursor(size_t rowIndex, size_t columnIndex) {
+	char sequence[48] = "\x1b[";
+	char* out = std::to_chars(sequence + 2, std::end(sequence), rowIndex + 1).ptr;
+
+	*out++ = ';';
+	out = std::to_chars(out, std::end(sequence), columnIndex + 1).ptr;
+	*out++ = 'H';
+	frame.append(sequence, out);
+}
+
+void TerminalRenderer::write(std::string_view bytes) const {
+	if (fileDescriptor < 0) return;
+
+	while (!bytes.empty()) {
+#ifdef _WIN32
+		const int written = _write(fileDescriptor, bytes.data(), static_cast<unsigned int>(bytes.size()));
+#else
+		const ssize_t written = ::write(fileDescriptor, bytes.data(), bytes.size());
+
+		if (written < 0 && errno == EINTR) continue;
+#endif
+
+		if (written <= 0) throw std::runtime_error("Failed to write a terminal frame");
+
+		bytes.remove_prefix(static_cast<size_t>(written));
+	}
+}
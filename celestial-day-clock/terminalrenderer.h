@@ -0,0 +1,68 @@
+#ifndef TERMINAL_RENDERER_H
+#define TERMINAL_RENDERER_H
+
+#include "renderedtimes.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Redraws lines of times in place with ANSI cursor positioning. Each frame is composed into one
+   buffer that holds only the cells changed since the previous frame and is written with a single
+   write call; lines beyond the visible region are paged with a status line */
+class TerminalRenderer {
+public:
+	static constexpr size_t defaultRows = 24;
+	static constexpr size_t defaultColumns = 80;
+	static constexpr int standardOutput = 1;
+
+	explicit TerminalRenderer(int fileDescriptor = standardOutput);
+
+	TerminalRenderer(int fileDescriptor, size_t rows, size_t columns);
+
+	~TerminalRenderer();
+
+	TerminalRenderer(const TerminalRenderer&) = delete;
+
+	TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+	size_t getRows() const { return rows; }
+
+	size_t getColumns() const { return columns; }
+
+	void setFirstLine(size_t line) { firstLine = line; }
+
+	size_t getFirstLine() const { return firstLine; }
+
+	const std::string& getFrame() const { return frame; }
+
+	void draw(const std::vector<std::string>& lines);
+
+	void draw(const RenderedTimes& times);
+
+	void redraw();
+
+	// The size of the terminal behind a file descriptor, or a default size if it is not a terminal
+	static void getTerminalSize(int fileDescriptor, size_t& rows, size_t& columns);
+
+private:
+	std::vector<std::string> screen;
+	std::vector<std::string_view> lineViews;
+	std::string frame;
+	std::string row;
+	size_t rows = defaultRows;
+	size_t columns = defaultColumns;
+	size_t firstLine = 0;
+	int fileDescriptor;
+	bool isCleared = false;
+
+	void drawLines(const std::vector<std::string_view>& lines);
+
+	void drawRow(size_t rowIndex, std::string_view text);
+
+	void moveCursor(size_t rowIndex, size_t columnIndex);
+
+	void write(std::string_view bytes) const;
+};
+
+#endif
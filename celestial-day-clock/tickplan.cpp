@@ -0,0 +1,63 @@
+#include "tickplan.h"
+#include "celestialdayclock.h"
+#include "tracer.h"
+#include <algorithm>
+#include <stdexcept>
+
+void TickPlan::compile(CelestialTimepiece& timepiece) {
+	CDC_TRACE_SCOPE("TickPlan::compile");
+
+	clocks.clear();
+	counters.clear();
+	boundaries.clear();
+	isCompiled = false;
+	timepiece.compileTickPlan(*this);
+	addBoundary();
+	revision = timepiece.getRevision();
+	isCompiled = true;
+	++compileCount;
+}
+
+bool TickPlan::isCurrent(const CelestialTimepiece& timepiece) const {
+	return isCompiled && timepiece.getRevision() == revision;
+}
+
+size_t TickPlan::getSplit() const {
+	const size_t middle = clocks.size() / 2;
+	const auto boundary = std::lower_bound(boundaries.begin(), boundaries.end(), middle);
+
+	if (boundary == boundaries.end()) return clocks.size();
+
+	if (boundary == boundaries.begin() || *boundary - middle <= middle - *(boundary - 1)) return *boundary;
+
+	return *(boundary - 1);
+}
+
+void TickPlan::addClocks(CelestialDayClock* const* leafClocks, size_t count) {
+	for (size_t index = 0; index < count; ++index) {
+		if (leafClocks[index] == nullptr)
+			throw std::runtime_error("Null clock pointer encountered in compileTickPlan");
+
+		clocks.push_back(leafClocks[index]);
+	}
+}
+
+void TickPlan::addCounter(std::atomic<std::uint64_t>& counter) { counters.push_back(&counter); }
+
+void TickPlan::addBoundary() {
+	if (boundaries.empty() || boundaries.back() != clocks.size()) boundaries.push_back(clocks.size());
+}
+
+void TickPlan::tick() {
+	tick(0, clocks.size());
+	tickCounters();
+}
+
+// Leaf clocks are ticked without virtual dispatch, as derived clocks never enter a plan and no other subclass may override tick
+void TickPlan::tick(size_t begin, size_t end) {
+	for (size_t index = begin; index < end; ++index) clocks[index]->CelestialDayClock::tick();
+}
+
+void TickPlan::tickCounters() {
+	for (std::atomic<std::uint64_t>* counter : counters) counter->fetch_add(1, std::memory_order_relaxed);
+}
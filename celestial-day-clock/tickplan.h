@@ -0,0 +1,54 @@
+#ifndef TICK_PLAN_H
+#define TICK_PLAN_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CelestialDayClock;
+class CelestialTimepiece;
+
+/* A timepiece hierarchy flattened into one dense array of the leaf clocks that tick, plus the tick
+   counters of the timepieces that hold them. Compiling walks the hierarchy once and validates it,
+   so a tick is a single linear sweep however deeply timepieces are nested. Boundaries mark where
+   each leaf timepiece's clocks end so the sweep can be split between threads without sharing one.
+   A plan holds raw pointers and must be compiled again whenever the hierarchy's revision changes */
+class TickPlan {
+public:
+	void compile(CelestialTimepiece& timepiece);
+
+	void invalidate() { isCompiled = false; }
+
+	bool isCurrent(const CelestialTimepiece& timepiece) const;
+
+	size_t getSize() const { return clocks.size(); }
+
+	size_t getCounterCount() const { return counters.size(); }
+
+	size_t getCompileCount() const { return compileCount; }
+
+	size_t getSplit() const;
+
+	void addClocks(CelestialDayClock* const* leafClocks, size_t count);
+
+	void addCounter(std::atomic<std::uint64_t>& counter);
+
+	void addBoundary();
+
+	void tick();
+
+	void tick(size_t begin, size_t end);
+
+	void tickCounters();
+
+private:
+	std::vector<CelestialDayClock*> clocks;
+	std::vector<std::atomic<std::uint64_t>*> counters;
+	std::vector<size_t> boundaries;
+	size_t revision = 0;
+	size_t compileCount = 0;
+	bool isCompiled = false;
+};
+
+#endif
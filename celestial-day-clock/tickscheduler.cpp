@@ -0,0 +1,137 @@
+#include "tickscheduler.h"
+#include "galactictimepiece.h"
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+TickTask::~TickTask() {
+	if (handle) handle.destroy();
+}
+
+bool TickTask::isDone() const { return !handle || handle.done(); }
+
+void TickTask::rethrow() const {
+	if (handle && handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+}
+
+TickScheduler::TickScheduler(std::chrono::nanoseconds interval) : interval(interval) {
+	if (interval.count() <= 0) throw std::invalid_argument("Tick interval must be positive");
+
+#ifdef __linux__
+	fileDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (fileDescriptor < 0) throw std::runtime_error("Failed to create the tick timer");
+#endif
+}
+
+TickScheduler::~TickScheduler() {
+	stop();
+
+#ifdef __linux__
+	close(fileDescriptor);
+#endif
+}
+
+void TickScheduler::add(CelestialTimepiece* timepiece) {
+	if (timepiece == nullptr) throw std::invalid_argument("Cannot schedule a null timepiece");
+
+	if (GalacticTimepiece* const galacticTimepiece = dynamic_cast<GalacticTimepiece*>(timepiece))
+		galacticTimepiece->setTickThreadCount(1);
+
+	timepieces.push_back(timepiece);
+}
+
+void TickScheduler::start() {
+	if (running) return;
+
+	running = true;
+	nextDeadline = std::chrono::steady_clock::now() + interval;
+
+#ifdef __linux__
+	const std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(interval);
+	const timespec period = { static_cast<time_t>(seconds.count()),
+		static_cast<long>((interval - seconds).count()) };
+	const itimerspec timerSpec = { period, period };
+
+	if (timerfd_settime(fileDescriptor, 0, &timerSpec, nullptr) < 0)
+		throw std::runtime_error("Failed to arm the tick timer");
+#endif
+}
+
+void TickScheduler::stop() {
+	if (!running) return;
+
+	running = false;
+
+#ifdef __linux__
+	const itimerspec timerSpec = {};
+
+	timerfd_settime(fileDescriptor, 0, &timerSpec, nullptr);
+#endif
+}
+
+void TickScheduler::onReadable() {
+	if (!running) return;
+
+	const std::uint64_t expirations = readExpirations();
+
+	if (expirations == 0) return;
+
+	for (std::uint64_t expiration = 0; expiration < expirations; ++expiration) {
+		for (CelestialTimepiece* timepiece : timepieces) timepiece->tick();
+
+		++tickCount;
+	}
+
+	std::vector<std::coroutine_handle<>> resumable;
+
+	resumable.swap(waiters);
+
+	for (std::coroutine_handle<> handle : resumable) handle.resume();
+}
+
+void TickScheduler::runOnce() {
+	start();
+
+#ifdef __linux__
+	pollfd pollDescriptor = { fileDescriptor, POLLIN, 0 };
+
+	while (poll(&pollDescriptor, 1, -1) < 0) {
+		if (errno != EINTR) throw std::runtime_error("Failed to wait for the tick timer");
+	}
+#else
+	std::this_thread::sleep_until(nextDeadline);
+#endif
+
+	onReadable();
+}
+
+std::uint64_t TickScheduler::readExpirations() {
+#ifdef __linux__
+	std::uint64_t expirations = 0;
+
+	if (read(fileDescriptor, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+		if (errno == EAGAIN) return 0;
+
+		throw std::runtime_error("Failed to read the tick timer");
+	}
+
+	return expirations;
+#else
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (now < nextDeadline) return 0;
+
+	const std::uint64_t expirations = (now - nextDeadline) / interval + 1;
+
+	nextDeadline += interval * expirations;
+
+	return expirations;
+#endif
+}
@@ -0,0 +1,104 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include "celestialtimepiece.h"
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+/* A coroutine that starts eagerly and keeps its frame until it is destroyed, so callers can poll
+   whether a tick-driven task has finished */
+class TickTask {
+public:
+	struct promise_type {
+		std::exception_ptr exception;
+
+		TickTask get_return_object() {
+			return TickTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_never initial_suspend() noexcept { return {}; }
+
+		std::suspend_always final_suspend() noexcept { return {}; }
+
+		void return_void() {}
+
+		void unhandled_exception() { exception = std::current_exception(); }
+	};
+
+	TickTask(TickTask&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+
+	TickTask(const TickTask&) = delete;
+
+	TickTask& operator=(const TickTask&) = delete;
+
+	~TickTask();
+
+	bool isDone() const;
+
+	void rethrow() const;
+
+private:
+	std::coroutine_handle<promise_type> handle;
+
+	explicit TickTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+/* Drives timepieces from an event loop thread: the loop waits on the scheduler's timer file
+   descriptor and calls onReadable, which ticks every timepiece and resumes awaiting coroutines */
+class TickScheduler {
+public:
+	class TickAwaiter {
+	public:
+		explicit TickAwaiter(TickScheduler& s) : scheduler(s) {}
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle) { scheduler.waiters.push_back(handle); }
+
+		std::uint64_t await_resume() const noexcept { return scheduler.tickCount; }
+
+	private:
+		TickScheduler& scheduler;
+	};
+
+	explicit TickScheduler(std::chrono::nanoseconds interval = std::chrono::seconds(1));
+
+	~TickScheduler();
+
+	TickScheduler(const TickScheduler&) = delete;
+
+	TickScheduler& operator=(const TickScheduler&) = delete;
+
+	// Galaxies are switched to ticking on one thread, so every tick runs on the loop thread alone
+	void add(CelestialTimepiece* timepiece);
+
+	int getFileDescriptor() const { return fileDescriptor; }
+
+	std::uint64_t getTickCount() const { return tickCount; }
+
+	void start();
+
+	void stop();
+
+	void onReadable();
+
+	void runOnce();
+
+	TickAwaiter nextTick() { return TickAwaiter(*this); }
+
+private:
+	std::vector<CelestialTimepiece*> timepieces;
+	std::vector<std::coroutine_handle<>> waiters;
+	std::chrono::nanoseconds interval;
+	std::chrono::steady_clock::time_point nextDeadline;
+	std::uint64_t tickCount = 0;
+	int fileDescriptor = -1;
+	bool running = false;
+
+	std::uint64_t readExpirations();
+};
+
+#endif
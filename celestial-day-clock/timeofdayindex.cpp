@@ -0,0 +1,142 @@
+#include "timeofdayindex.h"
+#include <algorithm>
+#include <map>
+
+TimeOfDayIndex::TimeOfDayIndex(const OrreryTimepiece& timepiece) : orreryTimepiece(&timepiece) {
+	rebuild();
+}
+
+TimeOfDayIndex::TimeOfDayIndex(GalacticTimepiece& timepiece) : galacticTimepiece(&timepiece) {
+	rebuild();
+}
+
+void TimeOfDayIndex::rebuild() {
+	std::map<DayProfile::Id, size_t> bucketIndices;
+
+	// Taken before the snapshot, so a clock set while it is taken leaves the index stale
+	builtStateEpoch = CelestialDayClock::getStateEpoch();
+
+	if (galacticTimepiece != nullptr) {
+		galacticTimepiece->snapshot(clockSnapshot);
+		builtRevision = galacticTimepiece->getRevision();
+		isTickDriven = true;
+
+		for (size_t index = 0; index < galacticTimepiece->getTimepieceCount(); ++index)
+			isTickDriven = isTickDriven && galacticTimepiece->getTimepieceAt(index).isTickDriven();
+	}
+	else {
+		orreryTimepiece->snapshot(clockSnapshot);
+		builtRevision = orreryTimepiece->getRevision();
+		isTickDriven = orreryTimepiece->isTickDriven();
+	}
+
+	buckets.clear();
+
+	for (size_t index = 0; index < clockSnapshot.getSize(); ++index) {
+		const DayProfile::Id profileId = clockSnapshot.profileIds[index];
+		const auto [itr, isInserted] = bucketIndices.emplace(profileId, buckets.size());
+
+		if (isInserted) buckets.push_back({ profileId, {} });
+
+		buckets[itr->second].clocks.emplace_back(clockSnapshot.secondsOfDay[index], index);
+	}
+
+	for (ProfileBucket& bucket : buckets) std::sort(bucket.clocks.begin(), bucket.clocks.end());
+}
+
+bool TimeOfDayIndex::isStale() const {
+	if (!isTickDriven || CelestialDayClock::getStateEpoch() != builtStateEpoch) return true;
+
+	if (galacticTimepiece != nullptr) return galacticTimepiece->getRevision() != builtRevision;
+
+	return orreryTimepiece->getRevision() != builtRevision;
+}
+
+int TimeOfDayIndex::getSecondsOfDay(size_t index) const {
+	const DayProfile& profile = DayProfile::get(clockSnapshot.profileIds[index]);
+
+	return (clockSnapshot.secondsOfDay[index] + getElapsedSeconds(profile)) % profile.daySeconds;
+}
+
+int TimeOfDayIndex::getSecondsToRollover(size_t index) const {
+	return DayProfile::get(clockSnapshot.profileIds[index]).daySeconds - getSecondsOfDay(index);
+}
+
+std::vector<size_t> TimeOfDayIndex::findBetween(const TimeOfDay& from, const TimeOfDay& to) const {
+	std::vector<size_t> indices;
+
+	for (const ProfileBucket& bucket : buckets) {
+		const DayProfile& profile = DayProfile::get(bucket.profileId);
+		const int fromSeconds = std::clamp(
+			profile.toSecondsOfDay(from.hours, from.minutes, from.seconds), 0, profile.daySeconds);
+		const int toSeconds = std::clamp(
+			profile.toSecondsOfDay(to.hours, to.minutes, to.seconds), 0, profile.daySeconds);
+
+		if (fromSeconds <= toSeconds) {
+			appendRange(bucket, fromSeconds, toSeconds, indices);
+		}
+		else {
+			appendRange(bucket, fromSeconds, profile.daySeconds, indices);
+			appendRange(bucket, 0, toSeconds, indices);
+		}
+	}
+
+	return indices;
+}
+
+std::vector<size_t> TimeOfDayIndex::findMeridiem(bool isPostMeridiem) const {
+	std::vector<size_t> indices;
+
+	for (const ProfileBucket& bucket : buckets) {
+		const DayProfile& profile = DayProfile::get(bucket.profileId);
+
+		if (isPostMeridiem) appendRange(bucket, profile.halfDaySeconds, profile.daySeconds, indices);
+		else appendRange(bucket, 0, profile.halfDaySeconds, indices);
+	}
+
+	return indices;
+}
+
+std::vector<size_t> TimeOfDayIndex::findNearRollover(int withinSeconds) const {
+	std::vector<size_t> indices;
+
+	for (const ProfileBucket& bucket : buckets) {
+		const DayProfile& profile = DayProfile::get(bucket.profileId);
+
+		appendRange(bucket, std::max(profile.daySeconds - withinSeconds, 0), profile.daySeconds, indices);
+	}
+
+	return indices;
+}
+
+std::uint64_t TimeOfDayIndex::getCurrentTick() const {
+	if (galacticTimepiece != nullptr) return galacticTimepiece->getTickCount();
+
+	return orreryTimepiece->getTickCount();
+}
+
+int TimeOfDayIndex::getElapsedSeconds(const DayProfile& profile) const {
+	return static_cast<int>((getCurrentTick() - clockSnapshot.tick) % profile.daySeconds);
+}
+
+void TimeOfDayIndex::appendRange(const ProfileBucket& bucket, int from, int to,
+	std::vector<size_t>& indices) const {
+	const DayProfile& profile = DayProfile::get(bucket.profileId);
+	const int length = to - from;
+	const int builtFrom = (from - getElapsedSeconds(profile) + profile.daySeconds) % profile.daySeconds;
+	const auto appendBuilt = [&bucket, &indices](int first, int last) {
+		auto itr = std::lower_bound(bucket.clocks.begin(), bucket.clocks.end(), std::make_pair(first, size_t(0)));
+
+		for (; itr != bucket.clocks.end() && itr->first < last; ++itr) indices.push_back(itr->second);
+		};
+
+	if (length <= 0) return;
+
+	if (builtFrom + length <= profile.daySeconds) {
+		appendBuilt(builtFrom, builtFrom + length);
+	}
+	else {
+		appendBuilt(builtFrom, profile.daySeconds);
+		appendBuilt(0, builtFrom + length - profile.daySeconds);
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef TIME_OF_DAY_INDEX_H
+#define TIME_OF_DAY_INDEX_H
+
+#include "clocksnapshot.h"
+#include "dayprofile.h"
+#include "galactictimepiece.h"
+#include "orrerytimepiece.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A military time of day on a body's clock
+struct TimeOfDay {
+	int hours;
+	int minutes;
+	int seconds;
+};
+
+/* An index of a timepiece's clocks by time of day. Clocks are bucketed per day profile and sorted by
+   seconds of day once; since every clock in a timepiece advances one second per tick, each bucket is
+   then rotated by the ticks elapsed since the build instead of being rebuilt. Queries return clock
+   indices in rendered order and cost time proportional to the result size. Setting any clock's time
+   directly, in any timepiece, makes the index stale. So does holding a clock that does not advance
+   with ticks, such as an epoch clock, so such an index is only current right after a rebuild */
+class TimeOfDayIndex {
+public:
+	explicit TimeOfDayIndex(const OrreryTimepiece& timepiece);
+
+	explicit TimeOfDayIndex(GalacticTimepiece& timepiece);
+
+	void rebuild();
+
+	bool isStale() const;
+
+	size_t getSize() const { return clockSnapshot.getSize(); }
+
+	int getSecondsOfDay(size_t index) const;
+
+	int getSecondsToRollover(size_t index) const;
+
+	std::vector<size_t> findBetween(const TimeOfDay& from, const TimeOfDay& to) const;
+
+	std::vector<size_t> findMeridiem(bool isPostMeridiem) const;
+
+	std::vector<size_t> findNearRollover(int withinSeconds) const;
+
+private:
+	struct ProfileBucket {
+		DayProfile::Id profileId;
+		std::vector<std::pair<int, size_t>> clocks;
+	};
+
+	const OrreryTimepiece* orreryTimepiece = nullptr;
+	GalacticTimepiece* galacticTimepiece = nullptr;
+	ClockSnapshot clockSnapshot;
+	std::vector<ProfileBucket> buckets;
+	size_t builtRevision = 0;
+	std::uint64_t builtStateEpoch = 0;
+	bool isTickDriven = true;
+
+	std::uint64_t getCurrentTick() const;
+
+	int getElapsedSeconds(const DayProfile& profile) const;
+
+	void appendRange(const ProfileBucket& bucket, int from, int to, std::vector<size_t>& indices) const;
+};
+
+#endif
@@ -0,0 +1,600 @@
+#include "timeserver.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static constexpr int maxEvents = 256;
+static constexpr size_t maxWriteBuffers = 64;
+static constexpr size_t readChunkSize = 4096;
+
+// Label paths leave out the separators that labels carry for display, such as "Earth: "
+static std::string_view trimLabel(std::string_view label) {
+	const size_t end = label.find_last_not_of(" :-.");
+
+	return end == std::string_view::npos ? std::string_view() : label.substr(0, end + 1);
+}
+
+static void signalEvent(int fileDescriptor) {
+	const std::uint64_t increment = 1;
+
+	while (write(fileDescriptor, &increment, sizeof(increment)) < 0 && errno == EINTR) {}
+}
+
+static void drainEvent(int fileDescriptor) {
+	std::uint64_t count = 0;
+
+	while (read(fileDescriptor, &count, sizeof(count)) < 0 && errno == EINTR) {}
+}
+
+static void closeDescriptor(int& fileDescriptor) {
+	if (fileDescriptor >= 0) close(fileDescriptor);
+
+	fileDescriptor = -1;
+}
+
+static sockaddr_in makeLoopbackAddress(std::uint16_t port) {
+	sockaddr_in address = {};
+
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	return address;
+}
+
+static sockaddr_un makeUnixAddress(const std::string& path) {
+	sockaddr_un address = {};
+
+	if (path.empty() || path.size() >= sizeof(address.sun_path))
+		throw std::invalid_argument("Invalid socket path " + path);
+
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.data(), path.size());
+
+	return address;
+}
+
+static std::shared_ptr<const std::string> makeReply(std::string_view kind, std::string_view text) {
+	std::string reply;
+
+	reply.reserve(kind.size() + text.size() + 2);
+	reply.append(kind).append(1, ' ').append(text).append(1, '\n');
+
+	return std::make_shared<const std::string>(std::move(reply));
+}
+
+TimeServer::TimeServer(GalacticTimepiece& timepiece) : timepiece(timepiece) {
+	epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	tickDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	stopDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (epollDescriptor < 0 || tickDescriptor < 0 || stopDescriptor < 0) {
+		closeDescriptor(epollDescriptor);
+		closeDescriptor(tickDescriptor);
+		closeDescriptor(stopDescriptor);
+		throw std::runtime_error("Failed to create the time server event loop");
+	}
+
+	watch(tickDescriptor, true, false, true);
+	watch(stopDescriptor, true, false, true);
+
+	const int tickEvent = tickDescriptor;
+
+	// Tick listeners run on the ticking thread, so the tick is only handed to the event loop here
+	tickListenerId = timepiece.addTickListener([tickEvent](std::uint64_t) { signalEvent(tickEvent); });
+}
+
+TimeServer::~TimeServer() {
+	timepiece.removeTickListener(tickListenerId);
+
+	for (const auto& [fileDescriptor, client] : clients) ::close(fileDescriptor);
+
+	closeDescriptor(tcpDescriptor);
+	closeDescriptor(unixDescriptor);
+	closeDescriptor(tickDescriptor);
+	closeDescriptor(stopDescriptor);
+	closeDescriptor(epollDescriptor);
+
+	if (!unixPath.empty()) unlink(unixPath.c_str());
+}
+
+std::uint16_t TimeServer::listenTcp(std::uint16_t port) {
+	if (tcpDescriptor >= 0) throw std::runtime_error("Time server is already listening on TCP");
+
+	int fileDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	sockaddr_in address = makeLoopbackAddress(port);
+	socklen_t addressSize = sizeof(address);
+	const int reuse = 1;
+
+	if (fileDescriptor < 0 || setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+		bind(fileDescriptor, reinterpret_cast<sockaddr*>(&address), addressSize) < 0 ||
+		listen(fileDescriptor, SOMAXCONN) < 0 ||
+		getsockname(fileDescriptor, reinterpret_cast<sockaddr*>(&address), &addressSize) < 0) {
+		closeDescriptor(fileDescriptor);
+		throw std::runtime_error("Failed to listen on TCP port " + std::to_string(port));
+	}
+
+	tcpDescriptor = fileDescriptor;
+	watch(tcpDescriptor, true, false, true);
+
+	return ntohs(address.sin_port);
+}
+
+void TimeServer::listenUnix(const std::string& path) {
+	if (unixDescriptor >= 0) throw std::runtime_error("Time server is already listening on a Unix socket");
+
+	const sockaddr_un address = makeUnixAddress(path);
+	int fileDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	unlink(path.c_str());
+
+	if (fileDescriptor < 0 ||
+		bind(fileDescriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+		listen(fileDescriptor, SOMAXCONN) < 0) {
+		closeDescriptor(fileDescriptor);
+		throw std::runtime_error("Failed to listen on socket " + path);
+	}
+
+	unixDescriptor = fileDescriptor;
+	unixPath = path;
+	watch(unixDescriptor, true, false, true);
+}
+
+void TimeServer::runOnce(int timeoutMilliseconds) {
+	epoll_event events[maxEvents];
+	const int eventCount = epoll_wait(epollDescriptor, events, maxEvents, timeoutMilliseconds);
+
+	if (eventCount < 0) {
+		if (errno == EINTR) return;
+
+		throw std::runtime_error("Failed to wait for time server events");
+	}
+
+	for (int eventIndex = 0; eventIndex < eventCount; ++eventIndex) {
+		const int fileDescriptor = events[eventIndex].data.fd;
+		const std::uint32_t flags = events[eventIndex].events;
+
+		if (fileDescriptor == tickDescriptor) {
+			onTick();
+		}
+		else if (fileDescriptor == stopDescriptor) {
+			drainEvent(stopDescriptor);
+		}
+		else if (fileDescriptor == tcpDescriptor || fileDescriptor == unixDescriptor) {
+			accept(fileDescriptor);
+		}
+		else {
+			const auto itr = clients.find(fileDescriptor);
+
+			if (itr == clients.end()) continue;
+
+			const bool wasReading = itr->second.isReading;
+
+			if ((flags & EPOLLOUT) && !flush(fileDescriptor, itr->second)) {
+				close(fileDescriptor);
+				continue;
+			}
+
+			// A client whose queue has drained may have requests left over from before it was held back
+			if ((flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) || (!wasReading && itr->second.isReading))
+				onReadable(fileDescriptor);
+		}
+	}
+}
+
+void TimeServer::run() {
+	while (!stopping) runOnce(-1);
+
+	stopping = false;
+}
+
+void TimeServer::stop() {
+	stopping = true;
+	signalEvent(stopDescriptor);
+}
+
+size_t TimeServer::getQueuedReplyCount() const {
+	size_t queuedReplyCount = 0;
+
+	for (const auto& [fileDescriptor, client] : clients) queuedReplyCount += client.output.size();
+
+	return queuedReplyCount;
+}
+
+void TimeServer::watch(int fileDescriptor, bool isReadable, bool isWritable, bool isNew) {
+	epoll_event event = {};
+
+	if (isReadable) event.events |= EPOLLIN;
+
+	if (isWritable) event.events |= EPOLLOUT;
+
+	event.data.fd = fileDescriptor;
+
+	if (epoll_ctl(epollDescriptor, isNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fileDescriptor, &event) < 0)
+		throw std::runtime_error("Failed to watch a time server socket");
+}
+
+void TimeServer::accept(int listenDescriptor) {
+	const int noDelay = 1;
+
+	while (true) {
+		const int fileDescriptor = accept4(listenDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+		if (fileDescriptor < 0) {
+			if (errno == EINTR) continue;
+
+			return;
+		}
+
+		if (listenDescriptor == tcpDescriptor)
+			setsockopt(fileDescriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+		clients.emplace(fileDescriptor, Client());
+		watch(fileDescriptor, true, false, true);
+	}
+}
+
+void TimeServer::onReadable(int fileDescriptor) {
+	Client& client = clients.at(fileDescriptor);
+	char buffer[readChunkSize];
+
+	while (true) {
+		handleRequests(client);
+
+		// Complete requests wait while the queue is full, so only an unfinished one can be too long
+		if (client.input.size() > maxRequestBytes && client.input.find('\n') == std::string::npos) {
+			close(fileDescriptor);
+
+			return;
+		}
+
+		// Reading stops until the socket takes enough of a full queue, after which EPOLLOUT resumes it
+		if (client.output.size() >= maxPendingReplies) {
+			if (!flush(fileDescriptor, client)) {
+				close(fileDescriptor);
+
+				return;
+			}
+
+			if (!client.isReading) return;
+
+			continue;
+		}
+
+		const ssize_t received = read(fileDescriptor, buffer, sizeof(buffer));
+
+		if (received < 0 && errno == EINTR) continue;
+
+		if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+		if (received <= 0) {
+			flush(fileDescriptor, client);
+			close(fileDescriptor);
+
+			return;
+		}
+
+		client.input.append(buffer, static_cast<size_t>(received));
+	}
+
+	if (!flush(fileDescriptor, client)) close(fileDescriptor);
+}
+
+void TimeServer::onTick() {
+	std::vector<int> failed;
+
+	drainEvent(tickDescriptor);
+
+	if (subscriberCount == 0) return;
+
+	updateFrame();
+
+	for (auto& [fileDescriptor, client] : clients) {
+		if (!client.isSubscribed || client.frameNumber == renderCount) continue;
+
+		// A subscriber that has fallen behind skips frames rather than queueing without bound
+		if (client.output.size() >= maxPendingFrames) {
+			++droppedFrameCount;
+			continue;
+		}
+
+		enqueue(client, frame);
+		client.frameNumber = renderCount;
+
+		if (!flush(fileDescriptor, client)) failed.push_back(fileDescriptor);
+	}
+
+	for (const int fileDescriptor : failed) close(fileDescriptor);
+}
+
+// Answers a client's complete requests until its queue is full, keeping the rest for once it drains
+void TimeServer::handleRequests(Client& client) {
+	size_t start = 0;
+	size_t end = 0;
+
+	while (client.output.size() < maxPendingReplies && (end = client.input.find('\n', start)) != std::string::npos) {
+		handleRequest(client, std::string_view(client.input).substr(start, end - start));
+		start = end + 1;
+	}
+
+	client.input.erase(0, start);
+}
+
+void TimeServer::handleRequest(Client& client, std::string_view request) {
+	if (!request.empty() && request.back() == '\r') request.remove_suffix(1);
+
+	if (request == "ALL" || request == "SUBSCRIBE") {
+		updateFrame();
+		enqueue(client, frame);
+		client.frameNumber = renderCount;
+
+		if (request == "SUBSCRIBE" && !client.isSubscribed) {
+			client.isSubscribed = true;
+			++subscriberCount;
+		}
+	}
+	else if (request == "UNSUBSCRIBE") {
+		if (client.isSubscribed) {
+			client.isSubscribed = false;
+			--subscriberCount;
+		}
+
+		enqueue(client, makeReply("OK", request));
+	}
+	else if (request.starts_with("GET ")) {
+		const std::string_view path = request.substr(4);
+
+		updateFrame();
+		indexLines();
+
+		const auto itr = lineIndices.find(std::string(path));
+
+		if (itr == lineIndices.end()) enqueue(client, makeReply("ERROR", "Unknown label path " + std::string(path)));
+		else enqueue(client, makeReply("TIME", times[itr->second]));
+	}
+	else {
+		enqueue(client, makeReply("ERROR", "Unknown request " + std::string(request)));
+	}
+}
+
+void TimeServer::updateFrame() {
+	const std::uint64_t currentTick = timepiece.getTickCount();
+	const size_t currentRevision = timepiece.getRevision();
+
+	if (frame && renderedTick == currentTick && renderedRevision == currentRevision) return;
+
+	std::shared_ptr<std::string> bytes = std::make_shared<std::string>();
+
+	timepiece.renderTimes(times);
+	bytes->reserve(frame ? frame->size() : 0);
+	bytes->append("TIMES ").append(std::to_string(currentTick)).append(1, ' ');
+	bytes->append(std::to_string(times.getSize())).append(1, '\n');
+
+	for (const std::string_view line : times) bytes->append(line).append(1, '\n');
+
+	frame = std::move(bytes);
+	renderedTick = currentTick;
+	renderedRevision = currentRevision;
+	++renderCount;
+}
+
+void TimeServer::indexLines() {
+	if (indexedRevision == renderedRevision && !lineIndices.empty()) return;
+
+	size_t line = 0;
+
+	lineIndices.clear();
+
+	for (size_t orreryIndex = 0; orreryIndex < timepiece.getTimepieceCount(); ++orreryIndex) {
+		const OrreryTimepiece& orreryTimepiece = timepiece.getTimepieceAt(orreryIndex);
+		const std::string orreryPath = std::string(trimLabel(timepiece.getLabelAt(orreryIndex))) + '/';
+
+		for (size_t index = 0; index < orreryTimepiece.getSize(); ++index)
+			lineIndices.emplace(orreryPath + std::string(trimLabel(orreryTimepiece.getLabelAt(index))), line++);
+	}
+
+	indexedRevision = renderedRevision;
+}
+
+void TimeServer::enqueue(Client& client, std::shared_ptr<const std::string> bytes) {
+	client.output.push_back(std::move(bytes));
+}
+
+bool TimeServer::flush(int fileDescriptor, Client& client) {
+	while (!client.output.empty()) {
+		iovec buffers[maxWriteBuffers];
+		msghdr message = {};
+		size_t bufferCount = 0;
+
+		for (auto itr = client.output.begin(); itr != client.output.end() && bufferCount < maxWriteBuffers;
+			++itr, ++bufferCount) {
+			const size_t offset = bufferCount == 0 ? client.outputOffset : 0;
+
+			buffers[bufferCount].iov_base = const_cast<char*>((*itr)->data() + offset);
+			buffers[bufferCount].iov_len = (*itr)->size() - offset;
+		}
+
+		message.msg_iov = buffers;
+		message.msg_iovlen = bufferCount;
+
+		const ssize_t written = sendmsg(fileDescriptor, &message, MSG_NOSIGNAL);
+
+		if (written < 0) {
+			if (errno == EINTR) continue;
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+			return false;
+		}
+
+		client.outputOffset += static_cast<size_t>(written);
+
+		while (!client.output.empty() && client.outputOffset >= client.output.front()->size()) {
+			client.outputOffset -= client.output.front()->size();
+			client.output.pop_front();
+		}
+	}
+
+	const bool isReading = client.output.size() < maxPendingReplies;
+	const bool isWaitingToWrite = !client.output.empty();
+
+	if (isReading != client.isReading || isWaitingToWrite != client.isWaitingToWrite) {
+		watch(fileDescriptor, isReading, isWaitingToWrite, false);
+		client.isReading = isReading;
+		client.isWaitingToWrite = isWaitingToWrite;
+	}
+
+	return true;
+}
+
+void TimeServer::close(int fileDescriptor) {
+	const auto itr = clients.find(fileDescriptor);
+
+	if (itr == clients.end()) return;
+
+	if (itr->second.isSubscribed) --subscriberCount;
+
+	epoll_ctl(epollDescriptor, EPOLL_CTL_DEL, fileDescriptor, nullptr);
+	::close(fileDescriptor);
+	clients.erase(itr);
+}
+
+TimeLoadGenerator::TimeLoadGenerator(std::uint16_t port) : port(port) {
+	epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+
+	if (epollDescriptor < 0) throw std::runtime_error("Failed to create the load generator event loop");
+}
+
+TimeLoadGenerator::TimeLoadGenerator(const std::string& socketPath) : unixPath(socketPath) {
+	makeUnixAddress(unixPath);
+	epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+
+	if (epollDescriptor < 0) throw std::runtime_error("Failed to create the load generator event loop");
+}
+
+TimeLoadGenerator::~TimeLoadGenerator() {
+	for (Connection& connection : connections) closeDescriptor(connection.fileDescriptor);
+
+	closeDescriptor(epollDescriptor);
+}
+
+void TimeLoadGenerator::connect(size_t connectionCount) {
+	connections.reserve(connections.size() + connectionCount);
+
+	for (size_t count = 0; count < connectionCount; ++count) {
+		const bool isUnix = !unixPath.empty();
+		int fileDescriptor = socket(isUnix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		const sockaddr_in tcpAddress = makeLoopbackAddress(port);
+		const sockaddr_un unixAddress = isUnix ? makeUnixAddress(unixPath) : sockaddr_un();
+		const sockaddr* const address = isUnix ? reinterpret_cast<const sockaddr*>(&unixAddress) :
+			reinterpret_cast<const sockaddr*>(&tcpAddress);
+		const socklen_t addressSize = isUnix ? sizeof(unixAddress) : sizeof(tcpAddress);
+		epoll_event event = {};
+
+		event.events = EPOLLIN;
+		event.data.u64 = connections.size();
+
+		// Connecting blocks only while the server's listen backlog is full
+		if (fileDescriptor < 0 || ::connect(fileDescriptor, address, addressSize) < 0 ||
+			fcntl(fileDescriptor, F_SETFL, fcntl(fileDescriptor, F_GETFL) | O_NONBLOCK) < 0 ||
+			epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) < 0) {
+			closeDescriptor(fileDescriptor);
+			throw std::runtime_error("Failed to connect to the time server");
+		}
+
+		connections.push_back(Connection());
+		connections.back().fileDescriptor = fileDescriptor;
+	}
+}
+
+void TimeLoadGenerator::send(std::string_view request) {
+	const std::string line = std::string(request) + '\n';
+
+	for (const Connection& connection : connections) {
+		if (connection.fileDescriptor < 0) continue;
+
+		if (::send(connection.fileDescriptor, line.data(), line.size(), MSG_NOSIGNAL) !=
+			static_cast<ssize_t>(line.size()))
+			throw std::runtime_error("Failed to send a request to the time server");
+	}
+}
+
+size_t TimeLoadGenerator::poll(int timeoutMilliseconds) {
+	epoll_event events[maxEvents];
+	const int eventCount = epoll_wait(epollDescriptor, events, maxEvents, timeoutMilliseconds);
+	size_t receivedBytes = 0;
+	char buffer[readChunkSize];
+
+	for (int eventIndex = 0; eventIndex < eventCount; ++eventIndex) {
+		const size_t connectionIndex = events[eventIndex].data.u64;
+		Connection& connection = connections[connectionIndex];
+
+		while (connection.fileDescriptor >= 0) {
+			const ssize_t received = read(connection.fileDescriptor, buffer, sizeof(buffer));
+
+			if (received < 0 && errno == EINTR) continue;
+
+			if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+			if (received <= 0) {
+				closeDescriptor(connection.fileDescriptor);
+				break;
+			}
+
+			size_t start = 0;
+			size_t end = 0;
+
+			receivedBytes += static_cast<size_t>(received);
+			connection.input.append(buffer, static_cast<size_t>(received));
+
+			while ((end = connection.input.find('\n', start)) != std::string::npos) {
+				receiveLine(connectionIndex, std::string_view(connection.input).substr(start, end - start));
+				start = end + 1;
+			}
+
+			connection.input.erase(0, start);
+		}
+	}
+
+	byteCount += receivedBytes;
+
+	return receivedBytes;
+}
+
+void TimeLoadGenerator::receiveLine(size_t connectionIndex, std::string_view line) {
+	Connection& connection = connections[connectionIndex];
+
+	if (connection.remainingFrameLines > 0) {
+		--connection.remainingFrameLines;
+
+		if (connectionIndex == 0) lastFrame.emplace_back(line);
+
+		return;
+	}
+
+	if (line.starts_with("TIMES ")) {
+		const std::string_view lineCount = line.substr(line.rfind(' ') + 1);
+
+		std::from_chars(lineCount.data(), lineCount.data() + lineCount.size(), connection.remainingFrameLines);
+		++frameCount;
+
+		if (connectionIndex == 0) lastFrame.clear();
+
+		return;
+	}
+
+	replies.emplace_back(line);
+}
+#endif
@@ -0,0 +1,162 @@
+#ifndef TIME_SERVER_H
+#define TIME_SERVER_H
+
+#include "galactictimepiece.h"
+#include "renderedtimes.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/* Serves a galactic timepiece's times over loopback TCP and Unix sockets from an epoll loop.
+   Requests are lines: "GET <orrery>/<clock>" answers "TIME <line>", "ALL" answers a frame of
+   "TIMES <tick> <count>" followed by that many lines, and "SUBSCRIBE" sends the current frame and
+   then one frame per tick. Each tick is rendered once into a frame shared by every subscriber, and
+   each client's queued responses are written together with one sendmsg. A client's requests are
+   only read while it has fewer than maxPendingReplies responses queued, so a client that pipelines
+   requests without reading the responses is held back by its own socket. Linux only, as it is built
+   on epoll and eventfd */
+class TimeServer {
+public:
+	static constexpr std::uint16_t defaultPort = 7177;
+	static constexpr size_t maxPendingFrames = 4;
+	static constexpr size_t maxPendingReplies = 64;
+	static constexpr size_t maxRequestBytes = 1024;
+
+	explicit TimeServer(GalacticTimepiece& timepiece);
+
+	~TimeServer();
+
+	TimeServer(const TimeServer&) = delete;
+
+	TimeServer& operator=(const TimeServer&) = delete;
+
+	std::uint16_t listenTcp(std::uint16_t port = defaultPort);
+
+	void listenUnix(const std::string& path);
+
+	size_t getClientCount() const { return clients.size(); }
+
+	size_t getSubscriberCount() const { return subscriberCount; }
+
+	std::uint64_t getRenderCount() const { return renderCount; }
+
+	std::uint64_t getDroppedFrameCount() const { return droppedFrameCount; }
+
+	size_t getQueuedReplyCount() const;
+
+	void runOnce(int timeoutMilliseconds);
+
+	void run();
+
+	void stop();
+
+private:
+	struct Client {
+		std::string input;
+		std::deque<std::shared_ptr<const std::string>> output;
+		size_t outputOffset = 0;
+		std::uint64_t frameNumber = 0;
+		bool isSubscribed = false;
+		bool isReading = true;
+		bool isWaitingToWrite = false;
+	};
+
+	GalacticTimepiece& timepiece;
+	std::unordered_map<int, Client> clients;
+	std::unordered_map<std::string, size_t> lineIndices;
+	std::shared_ptr<const std::string> frame;
+	RenderedTimes times;
+	std::string unixPath;
+	std::atomic<bool> stopping = false;
+	std::uint64_t renderedTick = 0;
+	std::uint64_t renderCount = 0;
+	std::uint64_t droppedFrameCount = 0;
+	size_t renderedRevision = 0;
+	size_t indexedRevision = 0;
+	size_t subscriberCount = 0;
+	size_t tickListenerId = 0;
+	int epollDescriptor = -1;
+	int tcpDescriptor = -1;
+	int unixDescriptor = -1;
+	int tickDescriptor = -1;
+	int stopDescriptor = -1;
+
+	void watch(int fileDescriptor, bool isReadable, bool isWritable, bool isNew);
+
+	void accept(int listenDescriptor);
+
+	void onReadable(int fileDescriptor);
+
+	void onTick();
+
+	void handleRequests(Client& client);
+
+	void handleRequest(Client& client, std::string_view request);
+
+	void updateFrame();
+
+	void indexLines();
+
+	void enqueue(Client& client, std::shared_ptr<const std::string> bytes);
+
+	bool flush(int fileDescriptor, Client& client);
+
+	void close(int fileDescriptor);
+};
+
+/* Opens many loopback connections to a time server and counts the frames and replies that come
+   back, which lets the server's tick fan-out be measured from a single thread */
+class TimeLoadGenerator {
+public:
+	explicit TimeLoadGenerator(std::uint16_t port);
+
+	explicit TimeLoadGenerator(const std::string& socketPath);
+
+	~TimeLoadGenerator();
+
+	TimeLoadGenerator(const TimeLoadGenerator&) = delete;
+
+	TimeLoadGenerator& operator=(const TimeLoadGenerator&) = delete;
+
+	void connect(size_t connectionCount);
+
+	void send(std::string_view request);
+
+	size_t poll(int timeoutMilliseconds);
+
+	size_t getConnectionCount() const { return connections.size(); }
+
+	std::uint64_t getFrameCount() const { return frameCount; }
+
+	std::uint64_t getByteCount() const { return byteCount; }
+
+	const std::vector<std::string>& getReplies() const { return replies; }
+
+	const std::vector<std::string>& getLastFrame() const { return lastFrame; }
+
+private:
+	struct Connection {
+		int fileDescriptor = -1;
+		std::string input;
+		size_t remainingFrameLines = 0;
+	};
+
+	std::vector<Connection> connections;
+	std::vector<std::string> replies;
+	std::vector<std::string> lastFrame;
+	std::string unixPath;
+	std::uint64_t frameCount = 0;
+	std::uint64_t byteCount = 0;
+	std::uint16_t port = 0;
+	int epollDescriptor = -1;
+
+	void receiveLine(size_t connectionIndex, std::string_view line);
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "timesource.h"
+#include <thread>
+
+SteadyTimeSource& SteadyTimeSource::getInstance() {
+	static SteadyTimeSource instance;
+
+	return instance;
+}
+
+TimeSource::TimePoint SteadyTimeSource::now() { return std::chrono::steady_clock::now(); }
+
+void SteadyTimeSource::sleepUntil(TimePoint timePoint) { std::this_thread::sleep_until(timePoint); }
+
+TimeSource::TimePoint VirtualTimeSource::now() {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	return current;
+}
+
+void VirtualTimeSource::sleepUntil(TimePoint timePoint) {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	if (timePoint > current) current = timePoint;
+}
+
+void VirtualTimeSource::advance(std::chrono::nanoseconds duration) {
+	std::lock_guard<std::mutex> lock(mtx);
+
+	current += duration;
+}
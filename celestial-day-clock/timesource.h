@@ -0,0 +1,43 @@
+#ifndef TIME_SOURCE_H
+#define TIME_SOURCE_H
+
+#include <chrono>
+#include <mutex>
+
+// ADT for a source of time that ticking loops read and sleep against
+class TimeSource {
+public:
+	using TimePoint = std::chrono::steady_clock::time_point;
+
+	virtual ~TimeSource() {};
+
+	virtual TimePoint now() = 0;
+
+	virtual void sleepUntil(TimePoint timePoint) = 0;
+};
+
+// A time source backed by std::chrono::steady_clock that really sleeps
+class SteadyTimeSource : public TimeSource {
+public:
+	static SteadyTimeSource& getInstance();
+
+	TimePoint now() override;
+
+	void sleepUntil(TimePoint timePoint) override;
+};
+
+// A simulated time source whose sleeps return instantly by jumping the virtual clock forward
+class VirtualTimeSource : public TimeSource {
+public:
+	TimePoint now() override;
+
+	void sleepUntil(TimePoint timePoint) override;
+
+	void advance(std::chrono::nanoseconds duration);
+
+private:
+	std::mutex mtx;
+	TimePoint current;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "tracer.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+struct TraceEvent {
+	const char* name;
+	std::int64_t beginNanoseconds;
+	std::int64_t durationNanoseconds;
+};
+
+struct TraceBuffer {
+	std::vector<TraceEvent> events;
+	std::uint64_t droppedCount = 0;
+	size_t threadId = 0;
+};
+
+struct ThreadTraceBuffer {
+	TraceBuffer* buffer = nullptr;
+	std::uint64_t generation = 0;
+};
+
+static std::atomic<bool> enabled = false;
+static std::atomic<std::uint64_t> generation = 1;
+static std::mutex buffersMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+static Tracer::Clock::time_point origin = Tracer::Clock::now();
+
+// Each thread registers its own buffer once per generation, so recording an event takes no lock
+static TraceBuffer& getThreadBuffer() {
+	thread_local ThreadTraceBuffer threadBuffer;
+	const std::uint64_t currentGeneration = generation.load(std::memory_order_acquire);
+
+	if (threadBuffer.generation != currentGeneration) {
+		std::lock_guard<std::mutex> lock(buffersMutex);
+
+		buffers.push_back(std::make_unique<TraceBuffer>());
+		buffers.back()->threadId = buffers.size();
+		threadBuffer = { buffers.back().get(), currentGeneration };
+	}
+
+	return *threadBuffer.buffer;
+}
+
+void Tracer::start() {
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	if (buffers.empty()) origin = Clock::now();
+
+	enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::stop() { enabled.store(false, std::memory_order_release); }
+
+bool Tracer::isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+void Tracer::record(const char* name, Clock::time_point begin, Clock::time_point end) {
+	TraceBuffer& buffer = getThreadBuffer();
+
+	if (buffer.events.size() == maxEventsPerThread) {
+		++buffer.droppedCount;
+
+		return;
+	}
+
+	buffer.events.push_back({ name, std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin).count(),
+		std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() });
+}
+
+size_t Tracer::getEventCount() {
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	size_t eventCount = 0;
+
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers) eventCount += buffer->events.size();
+
+	return eventCount;
+}
+
+std::uint64_t Tracer::getDroppedEventCount() {
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	std::uint64_t droppedCount = 0;
+
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers) droppedCount += buffer->droppedCount;
+
+	return droppedCount;
+}
+
+std::vector<TraceTotal> Tracer::summarize() {
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	std::unordered_map<const char*, size_t> totalIndices;
+	std::vector<TraceTotal> totals;
+
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers) {
+		for (const TraceEvent& event : buffer->events) {
+			const auto [itr, isNew] = totalIndices.try_emplace(event.name, totals.size());
+
+			if (isNew) totals.push_back({ event.name, 0, 0 });
+
+			++totals[itr->second].count;
+			totals[itr->second].totalNanoseconds += static_cast<std::uint64_t>(event.durationNanoseconds);
+		}
+	}
+
+	std::sort(totals.begin(), totals.end(), [](const TraceTotal& first, const TraceTotal& second) {
+		return first.totalNanoseconds > second.totalNanoseconds;
+		});
+
+	return totals;
+}
+
+// Trace-event timestamps are microseconds, which keeps nanosecond precision as three decimals
+static void writeMicroseconds(std::ostream& out, std::int64_t nanoseconds) {
+	const char fraction[] = { static_cast<char>('0' + nanoseconds % 1000 / 100),
+		static_cast<char>('0' + nanoseconds % 100 / 10), static_cast<char>('0' + nanoseconds % 10), '\0' };
+
+	out << nanoseconds / 1000 << '.' << fraction;
+}
+
+static void writeJsonString(std::ostream& out, const char* text) {
+	out << '"';
+
+	for (const char* itr = text; *itr != '\0'; ++itr) {
+		if (*itr == '"' || *itr == '\\') out << '\\';
+
+		out << *itr;
+	}
+
+	out << '"';
+}
+
+void Tracer::writeChromeTrace(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	bool isFirst = true;
+
+	out << "{\"traceEvents\":[";
+
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers) {
+		for (const TraceEvent& event : buffer->events) {
+			out << (isFirst ? "\n" : ",\n") << "{\"name\":";
+			writeJsonString(out, event.name);
+			out << ",\"cat\":\"cdc\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":";
+			writeMicroseconds(out, std::max<std::int64_t>(event.beginNanoseconds, 0));
+			out << ",\"dur\":";
+			writeMicroseconds(out, event.durationNanoseconds);
+			out << '}';
+			isFirst = false;
+		}
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void Tracer::writeChromeTrace(const std::string& path) {
+	std::ofstream out(path);
+
+	if (!out) throw std::runtime_error("Failed to open trace file " + path);
+
+	writeChromeTrace(out);
+}
+
+void Tracer::clear() {
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	buffers.clear();
+	generation.fetch_add(1, std::memory_order_acq_rel);
+}
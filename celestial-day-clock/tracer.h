@@ -0,0 +1,80 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// How often one probe ran while tracing and the total time spent inside it, including nested probes
+struct TraceTotal {
+	const char* name;
+	std::uint64_t count;
+	std::uint64_t totalNanoseconds;
+};
+
+/* Collects timed probe events from any thread into per-thread buffers while tracing is started, and
+   exports them as Chrome trace-event JSON for chrome://tracing or Perfetto. Probes cost one relaxed
+   load while tracing is stopped. Events should only be read, written or cleared once tracing has
+   stopped and traced work has finished */
+class Tracer {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr size_t maxEventsPerThread = 1 << 20;
+
+	static void start();
+
+	static void stop();
+
+	static bool isEnabled();
+
+	static void record(const char* name, Clock::time_point begin, Clock::time_point end);
+
+	static size_t getEventCount();
+
+	static std::uint64_t getDroppedEventCount();
+
+	static std::vector<TraceTotal> summarize();
+
+	static void writeChromeTrace(std::ostream& out);
+
+	static void writeChromeTrace(const std::string& path);
+
+	static void clear();
+};
+
+// Records the time between its construction and destruction under a probe name with static storage
+class TraceScope {
+public:
+	explicit TraceScope(const char* name) : name(name), isActive(Tracer::isEnabled()) {
+		if (isActive) begin = Tracer::Clock::now();
+	}
+
+	~TraceScope() {
+		if (isActive) Tracer::record(name, begin, Tracer::Clock::now());
+	}
+
+	TraceScope(const TraceScope&) = delete;
+
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	const char* name;
+	Tracer::Clock::time_point begin;
+	bool isActive;
+};
+
+// Hot-path probes are compiled in only when CDC_TRACE is defined
+#define CDC_TRACE_CONCAT_(a, b) a##b
+#define CDC_TRACE_CONCAT(a, b) CDC_TRACE_CONCAT_(a, b)
+
+#ifdef CDC_TRACE
+#define CDC_TRACE_SCOPE(name) const TraceScope CDC_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define CDC_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif